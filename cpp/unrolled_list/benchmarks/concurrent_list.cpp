@@ -0,0 +1,109 @@
+#include "../concurrent_unrolled_list.h"
+#include "../unrolled_list.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+constexpr int element_count = 200'000;
+constexpr int duration_ms = 500;
+
+// unrolled_list behind a reader-writer lock, the baseline.
+class locked_list
+{
+private:
+    unrolled_list<int, 32> list;
+    mutable std::shared_mutex mutex;
+
+public:
+    void push_back(int value)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        list.push_back(value);
+    }
+
+    template <typename Pred>
+    void erase_if(Pred pred)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        list.erase(std::remove_if(list.begin(), list.end(), pred), list.end());
+    }
+
+    template <typename F>
+    void for_each(F f) const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        for (int x : list)
+            f(x);
+    }
+};
+
+volatile long long sink;
+
+struct throughput
+{
+    double scans;
+    double writes;
+};
+
+// Readers scan the whole list while one writer appends and trims; counts
+// full scans per second over all readers and appends per second.
+template <typename List>
+throughput measure(int readers)
+{
+    List list;
+    for (int i = 0; i < element_count; ++i)
+        list.push_back(i);
+
+    std::atomic<bool> stop{false};
+    std::atomic<long long> scans{0};
+    long long writes = 0;
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; ++r)
+    {
+        threads.emplace_back([&] {
+            long long done = 0;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                long long sum = 0;
+                list.for_each([&](int x) { sum += x; });
+                sink = sum;
+                ++done;
+            }
+            scans += done;
+        });
+    }
+    threads.emplace_back([&] {
+        for (int next = element_count; !stop.load(std::memory_order_relaxed); ++next)
+        {
+            list.push_back(next);
+            if (next % 1024 == 0)
+                list.erase_if([next](int x) { return x < next - element_count; });
+            ++writes;
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+    stop = true;
+    for (std::thread &t : threads)
+        t.join();
+    return {scans.load() * 1000.0 / duration_ms, writes * 1000.0 / duration_ms};
+}
+
+int main()
+{
+    int max_readers = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+    std::printf("%d ints, one writer; full scans/s and appends/s\n", element_count);
+    std::printf("%8s %28s %28s\n", "readers", "shared_mutex list", "concurrent_unrolled_list");
+    for (int readers = 1; readers <= max_readers; readers *= 2)
+    {
+        throughput locked = measure<locked_list>(readers);
+        throughput concurrent = measure<concurrent_unrolled_list<int, 32>>(readers);
+        std::printf("%8d %12.1f %15.0f %12.1f %15.0f\n", readers, locked.scans, locked.writes, concurrent.scans,
+                    concurrent.writes);
+    }
+    return 0;
+}
@@ -0,0 +1,192 @@
+#include "../unrolled_list.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <list>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Compares unrolled_list against the standard sequence containers. Results
+// go to stdout as CSV, one row per (container, element, operation), so runs
+// can be diffed or loaded into a spreadsheet:
+//
+//     container,element,operation,elements,ns_per_op
+
+constexpr std::size_t element_count = 200'000;
+constexpr std::size_t middle_ops = 2'000;
+constexpr std::size_t random_reads = 200'000;
+constexpr int repeats = 3;
+
+struct pod64
+{
+    std::int64_t fields[8];
+};
+
+template <typename T>
+T make_value(std::size_t i)
+{
+    if constexpr (std::is_same_v<T, std::string>)
+        return std::string(32, static_cast<char>('a' + i % 26));
+    else if constexpr (std::is_same_v<T, pod64>)
+        return pod64{{static_cast<std::int64_t>(i)}};
+    else
+        return static_cast<T>(i);
+}
+
+template <typename T>
+std::size_t digest(const T &value)
+{
+    if constexpr (std::is_same_v<T, std::string>)
+        return value.size() + static_cast<std::size_t>(value[0]);
+    else if constexpr (std::is_same_v<T, pod64>)
+        return static_cast<std::size_t>(value.fields[0]);
+    else
+        return static_cast<std::size_t>(value);
+}
+
+volatile std::size_t sink;
+
+template <typename C>
+struct is_std_list : std::false_type
+{
+};
+
+template <typename T, typename A>
+struct is_std_list<std::list<T, A>> : std::true_type
+{
+};
+
+template <typename C>
+struct is_std_vector : std::false_type
+{
+};
+
+template <typename T, typename A>
+struct is_std_vector<std::vector<T, A>> : std::true_type
+{
+};
+
+// Best of `repeats` runs of setup() + f(); only f() is timed.
+template <typename Setup, typename F>
+double time_ns(std::size_t ops, Setup &&setup, F &&f)
+{
+    double best = 0;
+    for (int i = 0; i < repeats; ++i)
+    {
+        auto state = setup();
+        auto start = std::chrono::steady_clock::now();
+        f(state);
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best = i == 0 || ns < best ? ns : best;
+    }
+    return best / static_cast<double>(ops);
+}
+
+void report(const char *container, const char *element, const char *operation, double ns_per_op)
+{
+    std::printf("%s,%s,%s,%zu,%.3f\n", container, element, operation, element_count, ns_per_op);
+}
+
+template <typename C>
+C filled()
+{
+    C c;
+    for (std::size_t i = 0; i < element_count; ++i)
+    {
+        c.push_back(make_value<typename C::value_type>(i));
+    }
+    return c;
+}
+
+template <typename C>
+auto middle(C &c)
+{
+    return std::next(c.begin(), static_cast<std::ptrdiff_t>(c.size() / 2));
+}
+
+template <typename T, std::size_t N, typename A, typename P>
+auto middle(unrolled_list<T, N, A, P> &c)
+{
+    return c.iterator_at(c.size() / 2);
+}
+
+template <typename C>
+void run(const char *container, const char *element)
+{
+    using T = typename C::value_type;
+    auto empty = [] { return C(); };
+    auto full = [] { return filled<C>(); };
+
+    report(container, element, "push_back", time_ns(element_count, empty, [](C &c) {
+               for (std::size_t i = 0; i < element_count; ++i)
+                   c.push_back(make_value<T>(i));
+           }));
+
+    if constexpr (!is_std_vector<C>::value)
+    {
+        report(container, element, "push_front", time_ns(element_count, empty, [](C &c) {
+                   for (std::size_t i = 0; i < element_count; ++i)
+                       c.push_front(make_value<T>(i));
+               }));
+    }
+
+    report(container, element, "insert_middle", time_ns(middle_ops, full, [](C &c) {
+               for (std::size_t i = 0; i < middle_ops; ++i)
+                   c.insert(middle(c), make_value<T>(i));
+           }));
+
+    report(container, element, "erase_middle", time_ns(middle_ops, full, [](C &c) {
+               for (std::size_t i = 0; i < middle_ops; ++i)
+                   c.erase(middle(c));
+           }));
+
+    report(container, element, "iterate", time_ns(element_count, full, [](C &c) {
+               std::size_t sum = 0;
+               for (const T &value : c)
+                   sum += digest(value);
+               sink = sum;
+           }));
+
+    if constexpr (!is_std_list<C>::value)
+    {
+        report(container, element, "random_access", time_ns(random_reads, full, [](C &c) {
+                   std::mt19937 rng(11);
+                   std::size_t sum = 0;
+                   for (std::size_t i = 0; i < random_reads; ++i)
+                       sum += digest(c[rng() % c.size()]);
+                   sink = sum;
+               }));
+    }
+
+    report(container, element, "copy", time_ns(element_count, full, [](C &c) {
+               C copy(c);
+               sink = copy.size();
+           }));
+}
+
+template <typename T>
+void run_element(const char *element)
+{
+    run<std::vector<T>>("std::vector", element);
+    run<std::deque<T>>("std::deque", element);
+    run<std::list<T>>("std::list", element);
+    run<unrolled_list<T, 16>>("unrolled_list<16>", element);
+    run<unrolled_list<T, 64>>("unrolled_list<64>", element);
+    run<unrolled_list<T, 256>>("unrolled_list<256>", element);
+    run<unrolled_list<T, 64, std::allocator<T>, half_full_policy>>("unrolled_list<64 half>", element);
+    run<unrolled_list<T, 64, std::allocator<T>, indexed_policy>>("unrolled_list<64 indexed>", element);
+    run<unrolled_list<T, 10, std::allocator<T>, byte_budget_policy<4096>>>("unrolled_list<4KB>", element);
+}
+
+int main()
+{
+    std::printf("container,element,operation,elements,ns_per_op\n");
+    run_element<int>("int");
+    run_element<std::string>("string");
+    run_element<pod64>("pod64");
+    return 0;
+}
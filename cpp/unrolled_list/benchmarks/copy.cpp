@@ -0,0 +1,47 @@
+#include "../unrolled_list.h"
+#include "timing.h"
+#include <cstdio>
+#include <string>
+
+constexpr std::size_t element_count = 2'000'000;
+constexpr int repeats = 5;
+
+volatile std::size_t sink;
+
+template <typename List, typename Make>
+void run(const char *name, Make make)
+{
+    List source;
+    for (std::size_t i = 0; i < element_count; ++i)
+        source.push_back(make(i));
+
+    // What the copy constructor used to do: one push_back per element.
+    double element_wise = time_ms<repeats>([&] {
+        List copy;
+        for (const auto &item : source)
+            copy.push_back(item);
+        sink = copy.size();
+    });
+    double construct = time_ms<repeats>([&] {
+        List copy(source);
+        sink = copy.size();
+    });
+    List target(source);
+    double assign = time_ms<repeats>([&] {
+        target = source;
+        sink = target.size();
+    });
+    std::printf("%-28s %12.2f %12.2f %12.2f\n", name, element_wise, construct, assign);
+}
+
+int main()
+{
+    std::printf("copy %zu elements, ms\n", element_count);
+    std::printf("%-28s %12s %12s %12s\n", "list", "push_back", "copy ctor", "copy assign");
+    run<unrolled_list<int, 64>>("unrolled_list<int, 64>", [](std::size_t i) { return static_cast<int>(i); });
+    run<unrolled_list<double, 16>>("unrolled_list<double, 16>", [](std::size_t i) { return i * 0.5; });
+    run<unrolled_list<int, 64, std::allocator<int>, ring_buffer_policy>>(
+        "ring_buffer_policy<int, 64>", [](std::size_t i) { return static_cast<int>(i); });
+    run<unrolled_list<std::string, 16>>("unrolled_list<string, 16>", [](std::size_t i) { return std::to_string(i); });
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "../mapped_unrolled_list.h"
+#include "timing.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+constexpr std::size_t element_count = 20'000'000;
+const char *const text_path = "unrolled_list_bench.txt";
+const char *const binary_path = "unrolled_list_bench.bin";
+
+volatile long long sink;
+
+int main()
+{
+    using list_type = unrolled_list<long long, 256>;
+    list_type list;
+    for (std::size_t i = 0; i < element_count; ++i)
+        list.push_back(static_cast<long long>(i * 2654435761u % 1000000007u));
+
+    double write_text = time_ms([&] {
+        std::ofstream out(text_path);
+        for (long long x : list)
+            out << x << '\n';
+    });
+    double read_text = time_ms([&] {
+        std::ifstream in(text_path);
+        list_type loaded;
+        long long x;
+        while (in >> x)
+            loaded.push_back(x);
+        sink = static_cast<long long>(loaded.size());
+    });
+    double save = time_ms([&] { list.save(binary_path); });
+    double load = time_ms([&] {
+        list_type loaded;
+        loaded.load(binary_path);
+        sink = static_cast<long long>(loaded.size());
+    });
+    double open = time_ms([&] {
+        mapped_unrolled_list<long long> mapped(binary_path);
+        sink = static_cast<long long>(mapped.size()) + *mapped.begin();
+    });
+    mapped_unrolled_list<long long> mapped(binary_path);
+    double scan = time_ms([&] {
+        long long sum = 0;
+        mapped.for_each_segment([&](auto seg) {
+            for (long long x : seg)
+                sum += x;
+        });
+        sink = sum;
+    });
+
+    std::printf("%zu long longs\n", element_count);
+    std::printf("%-36s %10.2f ms\n", "write text", write_text);
+    std::printf("%-36s %10.2f ms\n", "rebuild from text", read_text);
+    std::printf("%-36s %10.2f ms\n", "save()", save);
+    std::printf("%-36s %10.2f ms\n", "load()", load);
+    std::printf("%-36s %10.2f ms\n", "mapped_unrolled_list open + front", open);
+    std::printf("%-36s %10.2f ms\n", "mapped_unrolled_list full scan", scan);
+    std::remove(text_path);
+    std::remove(binary_path);
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include "../unrolled_list.h"
+#include "../unrolled_queue.h"
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+constexpr long items_per_producer = 2'000'000;
+constexpr std::size_t batch = 64;
+
+// unrolled_list used as a FIFO behind one mutex, the baseline.
+class locked_queue
+{
+private:
+    unrolled_list<long, 64> list;
+    std::mutex mutex;
+
+public:
+    void push(long value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        list.push_back(value);
+    }
+
+    template <typename InputIt>
+    void push_bulk(InputIt first, InputIt last)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (; first != last; ++first)
+            list.push_back(*first);
+    }
+
+    bool try_pop(long &out)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (list.empty())
+            return false;
+        out = list.front();
+        list.pop_front();
+        return true;
+    }
+
+    template <typename OutputIt>
+    std::size_t pop_bulk(OutputIt out, std::size_t max)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::size_t n = 0;
+        for (; n < max && !list.empty(); ++n, ++out)
+        {
+            *out = list.front();
+            list.pop_front();
+        }
+        return n;
+    }
+};
+
+volatile long sink;
+
+// Millions of items per second moved from producers to consumers.
+template <typename Queue>
+double throughput(int producers, int consumers, bool bulk)
+{
+    Queue queue;
+    long total = items_per_producer * producers;
+    std::atomic<long> consumed{0};
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&] {
+            std::vector<long> items(batch);
+            for (long i = 0; i < items_per_producer; i += bulk ? batch : 1)
+            {
+                if (bulk)
+                    queue.push_bulk(items.begin(), items.end());
+                else
+                    queue.push(i);
+            }
+        });
+    }
+    for (int c = 0; c < consumers; ++c)
+    {
+        threads.emplace_back([&] {
+            std::vector<long> items(batch);
+            long sum = 0;
+            long value = 0;
+            while (consumed.load(std::memory_order_relaxed) < total)
+            {
+                std::size_t n = bulk ? queue.pop_bulk(items.begin(), batch) : queue.try_pop(value);
+                if (n)
+                    consumed.fetch_add(static_cast<long>(n), std::memory_order_relaxed);
+                else
+                    std::this_thread::yield();
+                sum += value;
+            }
+            sink = sum;
+        });
+    }
+    for (std::thread &t : threads)
+        t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total / seconds / 1e6;
+}
+
+void run(const char *shape, int producers, int consumers, bool lock_free_spsc)
+{
+    for (bool bulk : {false, true})
+    {
+        double locked = throughput<locked_queue>(producers, consumers, bulk);
+        double queue = lock_free_spsc ? throughput<spsc_unrolled_queue<long, 64>>(producers, consumers, bulk)
+                                      : throughput<mpmc_unrolled_queue<long, 64>>(producers, consumers, bulk);
+        std::printf("%-6s %-6s %12.1f %12.1f  (%s)\n", shape, bulk ? "bulk" : "single", locked, queue,
+                    lock_free_spsc ? "spsc" : "mpmc");
+    }
+}
+
+int main()
+{
+    std::printf("Mitems/s; bulk moves %zu items per call\n", batch);
+    std::printf("%-6s %-6s %12s %12s\n", "shape", "ops", "mutex list", "unrolled q");
+    run("1p1c", 1, 1, true);
+    run("1p1c", 1, 1, false);
+    run("2p2c", 2, 2, false);
+    run("4p4c", 4, 4, false);
+    return 0;
+}
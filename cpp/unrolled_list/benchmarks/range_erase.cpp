@@ -0,0 +1,51 @@
+#include "../unrolled_list.h"
+#include "timing.h"
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+constexpr std::size_t element_count = 10'000'000;
+
+template <typename Container>
+void erase_middle_half(const char *name)
+{
+    Container c;
+    for (std::size_t i = 0; i < element_count; ++i)
+    {
+        c.push_back(static_cast<int>(i));
+    }
+    auto first = c.begin();
+    auto last = c.begin();
+    std::advance(first, element_count / 4);
+    std::advance(last, element_count / 4 * 3);
+
+    double ms = time_ms([&] { c.erase(first, last); });
+    std::printf("%-28s %10.2f ms  (%zu left)\n", name, ms, c.size());
+}
+
+template <typename List>
+void erase_middle_half_list(const char *name)
+{
+    List c;
+    for (std::size_t i = 0; i < element_count; ++i)
+    {
+        c.push_back(static_cast<int>(i));
+    }
+    auto first = c.begin() + element_count / 4;
+    auto last = c.begin() + element_count / 4 * 3;
+
+    double ms = time_ms([&] { c.erase(first, last); });
+    std::printf("%-28s %10.2f ms  (%zu left)\n", name, ms, c.size());
+}
+
+int main()
+{
+    std::printf("erase middle 50%% of %zu ints\n", element_count);
+    erase_middle_half_list<unrolled_list<int, 16>>("unrolled_list<int, 16>");
+    erase_middle_half_list<unrolled_list<int, 64>>("unrolled_list<int, 64>");
+    erase_middle_half_list<unrolled_list<int, 256>>("unrolled_list<int, 256>");
+    erase_middle_half_list<unrolled_list<int, 64, std::allocator<int>, half_full_policy>>("unrolled_list<int, 64, half>");
+    erase_middle_half<std::vector<int>>("std::vector<int>");
+    erase_middle_half<std::deque<int>>("std::deque<int>");
+    return 0;
+}
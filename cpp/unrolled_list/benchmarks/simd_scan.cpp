@@ -0,0 +1,54 @@
+#include "../unrolled_list.h"
+#include "timing.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <random>
+
+constexpr std::size_t element_count = 10'000'000;
+constexpr int repeats = 5;
+
+template <typename T>
+volatile T sink;
+
+template <typename List>
+void scan(const char *name)
+{
+    using T = typename List::value_type;
+    List list;
+    std::mt19937 rng(42);
+    for (std::size_t i = 0; i < element_count; ++i)
+    {
+        list.push_back(static_cast<T>(rng() % 1000));
+    }
+    list.back() = static_cast<T>(5000);
+    const T needle = static_cast<T>(5000);
+
+    double generic_find = time_ms<repeats>([&] { sink<T> = *std::find(list.begin(), list.end(), needle); });
+    double member_find = time_ms<repeats>([&] { sink<T> = *list.find(needle); });
+    double generic_count = time_ms<repeats>([&] { sink<T> = static_cast<T>(std::count(list.begin(), list.end(), needle)); });
+    double member_count = time_ms<repeats>([&] { sink<T> = static_cast<T>(list.count(needle)); });
+    double generic_min = time_ms<repeats>([&] { sink<T> = *std::min_element(list.begin(), list.end()); });
+    double member_min = time_ms<repeats>([&] { sink<T> = *list.min_element(); });
+    double generic_sum = time_ms<repeats>([&] { sink<T> = std::accumulate(list.begin(), list.end(), T()); });
+    double member_sum = time_ms<repeats>([&] { sink<T> = list.accumulate(); });
+
+    std::printf("%-30s find %7.2f -> %6.2f  count %7.2f -> %6.2f  min %7.2f -> %6.2f  sum %7.2f -> %6.2f ms\n", name,
+                generic_find, member_find, generic_count, member_count, generic_min, member_min, generic_sum, member_sum);
+}
+
+int main()
+{
+    const char *isa[] = {"scalar", "sse2", "avx2"};
+    std::printf("%zu elements, generic std:: algorithm -> member kernel (%s)\n", element_count,
+                isa[static_cast<int>(detected_simd_isa())]);
+    scan<unrolled_list<std::int32_t, 10>>("unrolled_list<int32_t, 10>");
+    scan<unrolled_list<std::int32_t, 64>>("unrolled_list<int32_t, 64>");
+    scan<unrolled_list<std::int32_t, 256>>("unrolled_list<int32_t, 256>");
+    scan<unrolled_list<float, 64>>("unrolled_list<float, 64>");
+    scan<unrolled_list<double, 10>>("unrolled_list<double, 10>");
+    scan<unrolled_list<double, 64>>("unrolled_list<double, 64>");
+    scan<unrolled_list<double, 256>>("unrolled_list<double, 256>");
+    return 0;
+}
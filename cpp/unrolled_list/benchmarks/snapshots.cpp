@@ -0,0 +1,56 @@
+#include "../persistent_unrolled_list.h"
+#include "../unrolled_list.h"
+#include "timing.h"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+constexpr std::size_t element_count = 1'000'000;
+constexpr int snapshot_count = 200;
+constexpr int writes_per_snapshot = 10;
+
+volatile long long sink;
+
+// A writer keeps a history of snapshots for readers, overwriting a few
+// random elements between two snapshots.
+template <typename List, typename Set>
+double run(List &list, Set set)
+{
+    std::mt19937 rng(11);
+    std::vector<List> history;
+    history.reserve(snapshot_count);
+    double ms = time_ms([&] {
+        for (int s = 0; s < snapshot_count; ++s)
+        {
+            history.push_back(list);
+            for (int w = 0; w < writes_per_snapshot; ++w)
+                set(list, rng() % element_count, static_cast<int>(rng()));
+        }
+    });
+    sink = static_cast<long long>(history.size());
+    return ms;
+}
+
+int main()
+{
+    unrolled_list<int, 64> plain;
+    persistent_unrolled_list<int, 64> persistent;
+    for (std::size_t i = 0; i < element_count; ++i)
+    {
+        plain.push_back(static_cast<int>(i));
+        persistent.push_back(static_cast<int>(i));
+    }
+
+    double copy_ms = run(plain, [](unrolled_list<int, 64> &l, std::size_t i, int v) { l[i] = v; });
+    double cow_ms = run(persistent, [](persistent_unrolled_list<int, 64> &l, std::size_t i, int v) { l.set(i, v); });
+    persistent_unrolled_list<int, 64> before = persistent.snapshot();
+    persistent.set(element_count / 2, -1);
+
+    std::printf("%zu ints, %d snapshots, %d writes between snapshots\n", element_count, snapshot_count,
+                writes_per_snapshot);
+    std::printf("%-44s %10.2f ms\n", "unrolled_list copy constructor", copy_ms);
+    std::printf("%-44s %10.2f ms\n", "persistent_unrolled_list snapshot()", cow_ms);
+    std::printf("nodes per version %zu, nodes not shared after one write %zu\n", persistent.node_count(),
+                persistent.node_count() - persistent.shared_node_count(before));
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include "../unrolled_list.h"
+#include "timing.h"
+#include <cstdint>
+#include <cstdio>
+
+constexpr std::size_t element_count = 5'000'000;
+constexpr int repeats = 5;
+
+// 64-byte record of which the scans read one field.
+struct record
+{
+    double price;
+    double weight;
+    std::int64_t id;
+    std::int64_t owner;
+    double extra[4];
+};
+
+template <>
+struct soa_traits<record>
+{
+    using fields = soa_fields<&record::price, &record::weight, &record::id, &record::owner, &record::extra>;
+};
+
+volatile double sink;
+
+template <typename List>
+List filled()
+{
+    List list;
+    for (std::size_t i = 0; i < element_count; ++i)
+    {
+        list.push_back(record{static_cast<double>(i % 1000), 1.0, static_cast<std::int64_t>(i), 0, {}});
+    }
+    return list;
+}
+
+int main()
+{
+    using aos_list = unrolled_list<record, 64>;
+    using soa_list = unrolled_list<record, 64, std::allocator<record>, soa_policy<>>;
+
+    aos_list aos = filled<aos_list>();
+    soa_list soa = filled<soa_list>();
+
+    double aos_loop = time_ms<repeats>([&] {
+        double sum = 0;
+        for (const record &r : aos)
+            sum += r.price;
+        sink = sum;
+    });
+    double aos_segments = time_ms<repeats>([&] {
+        double sum = 0;
+        aos.for_each_segment([&](auto seg) {
+            for (const record &r : seg)
+                sum += r.price;
+        });
+        sink = sum;
+    });
+    double soa_segments = time_ms<repeats>([&] {
+        double sum = 0;
+        soa.for_each_field_segment<&record::price>([&](auto seg) {
+            for (double price : seg)
+                sum += price;
+        });
+        sink = sum;
+    });
+    double soa_simd = time_ms<repeats>([&] { sink = soa.accumulate_field<&record::price>(); });
+
+    std::printf("sum one double field of %zu 64-byte records\n", element_count);
+    std::printf("%-40s %8.2f ms\n", "AoS, element iterator", aos_loop);
+    std::printf("%-40s %8.2f ms\n", "AoS, for_each_segment", aos_segments);
+    std::printf("%-40s %8.2f ms\n", "SoA, for_each_field_segment", soa_segments);
+    std::printf("%-40s %8.2f ms\n", "SoA, accumulate_field (SIMD)", soa_simd);
+    return 0;
+}
@@ -0,0 +1,49 @@
+#include "../parallel_algorithms.h"
+#include "timing.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+constexpr std::size_t element_count = 2'000'000;
+
+template <typename List>
+List random_list()
+{
+    std::mt19937 rng(7);
+    List list;
+    for (std::size_t i = 0; i < element_count; ++i)
+    {
+        list.push_back(static_cast<int>(rng()));
+    }
+    return list;
+}
+
+template <typename List>
+void sort_variants(const char *name, thread_pool &pool)
+{
+    List a = random_list<List>();
+    double via_vector = time_ms([&] {
+        std::vector<int> v(a.begin(), a.end());
+        std::sort(v.begin(), v.end());
+        a = List(v.begin(), v.end());
+    });
+    List b = random_list<List>();
+    double member = time_ms([&] { b.sort(); });
+    List c = random_list<List>();
+    double stable = time_ms([&] { c.stable_sort(); });
+    List d = random_list<List>();
+    double parallel = time_ms([&] { parallel_sort(pool, d); });
+    std::printf("%-28s vector round trip %8.2f  sort %8.2f  stable_sort %8.2f  parallel_sort %8.2f ms\n", name,
+                via_vector, member, stable, parallel);
+}
+
+int main()
+{
+    thread_pool pool;
+    std::printf("sort %zu random ints, %zu threads\n", element_count, pool.size());
+    sort_variants<unrolled_list<int, 16>>("unrolled_list<int, 16>", pool);
+    sort_variants<unrolled_list<int, 64>>("unrolled_list<int, 64>", pool);
+    sort_variants<unrolled_list<int, 256>>("unrolled_list<int, 256>", pool);
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include "../sorted_unrolled_list.h"
+#include "timing.h"
+#include <cstdio>
+#include <random>
+#include <set>
+#include <vector>
+
+constexpr std::size_t element_count = 1'000'000;
+
+volatile long long sink;
+
+template <typename Set>
+void run(const char *name, const std::vector<int> &keys, const std::vector<int> &probes)
+{
+    Set set;
+    double insert = time_ms([&] {
+        for (int key : keys)
+            set.insert(key);
+    });
+    double find = time_ms([&] {
+        long long hits = 0;
+        for (int key : probes)
+            hits += set.find(key) != set.end();
+        sink = hits;
+    });
+    double scan = time_ms([&] {
+        long long sum = 0;
+        for (int key : set)
+            sum += key;
+        sink = sum;
+    });
+    double erase = time_ms([&] {
+        for (int key : probes)
+            set.erase(key);
+    });
+    std::printf("%-36s insert %8.2f  find %8.2f  scan %7.2f  erase %8.2f ms\n", name, insert, find, scan, erase);
+}
+
+int main()
+{
+    std::mt19937 rng(3);
+    std::vector<int> keys(element_count);
+    std::vector<int> probes(element_count);
+    for (std::size_t i = 0; i < element_count; ++i)
+    {
+        keys[i] = static_cast<int>(rng());
+        probes[i] = i % 2 ? keys[rng() % element_count] : static_cast<int>(rng());
+    }
+
+    std::printf("%zu random ints\n", element_count);
+    run<std::set<int>>("std::set<int>", keys, probes);
+    run<sorted_unrolled_list<int, 32>>("sorted_unrolled_list<int, 32>", keys, probes);
+    run<sorted_unrolled_list<int, 128>>("sorted_unrolled_list<int, 128>", keys, probes);
+    run<sorted_unrolled_list<int, 512>>("sorted_unrolled_list<int, 512>", keys, probes);
+    run<sorted_unrolled_list<int, 10, std::less<int>, std::allocator<int>, byte_budget_policy<4096, half_full_policy>>>(
+        "sorted_unrolled_list<int, 4KB half>", keys, probes);
+    return 0;
+}
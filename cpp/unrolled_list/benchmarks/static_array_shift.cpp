@@ -0,0 +1,77 @@
+#include "../static_array.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+struct Record
+{
+    std::int64_t key;
+    double payload[7];
+};
+
+struct BoxedInt
+{
+    int value;
+
+    BoxedInt(int v) : value(v) {}
+    BoxedInt(const BoxedInt &other) : value(other.value) {}
+    BoxedInt &operator=(const BoxedInt &other)
+    {
+        value = other.value;
+        return *this;
+    }
+};
+
+template <typename T>
+T make_value(std::size_t i)
+{
+    return T(static_cast<int>(i));
+}
+
+template <>
+Record make_value<Record>(std::size_t i)
+{
+    return Record{static_cast<std::int64_t>(i), {}};
+}
+
+template <typename T, std::size_t NodeMaxSize>
+void middle_insert(const char *type_name)
+{
+    static StaticArray<T, NodeMaxSize> array;
+    array.clear();
+    for (std::size_t i = 0; i < NodeMaxSize / 2; ++i)
+    {
+        array.push_back(make_value<T>(i));
+    }
+
+    const std::size_t rounds = (std::size_t(1) << 24) / NodeMaxSize;
+    const T value = make_value<T>(42);
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t r = 0; r < rounds; ++r)
+    {
+        std::size_t mid = array.size() / 2;
+        array.insert(mid, value);
+        array.erase(mid);
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%-10s %6zu %12.2f\n", type_name, NodeMaxSize, elapsed / rounds);
+}
+
+template <typename T>
+void run(const char *type_name)
+{
+    middle_insert<T, 16>(type_name);
+    middle_insert<T, 64>(type_name);
+    middle_insert<T, 256>(type_name);
+    middle_insert<T, 1024>(type_name);
+}
+
+int main()
+{
+    std::printf("%-10s %6s %12s\n", "type", "N", "ns/op");
+    run<int>("int");
+    run<BoxedInt>("BoxedInt");
+    run<Record>("Record");
+    return 0;
+}
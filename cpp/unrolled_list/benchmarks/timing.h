@@ -0,0 +1,21 @@
+#ifndef UNROLLED_LIST_BENCHMARK_TIMING_H
+#define UNROLLED_LIST_BENCHMARK_TIMING_H
+
+#include <chrono>
+
+// Wall time of f() in milliseconds, the best of Runs calls.
+template <int Runs = 1, typename F>
+double time_ms(F &&f)
+{
+    double best = 0;
+    for (int i = 0; i < Runs; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = i == 0 || ms < best ? ms : best;
+    }
+    return best;
+}
+
+#endif
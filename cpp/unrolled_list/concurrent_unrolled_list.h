@@ -0,0 +1,411 @@
+#ifndef CONCURRENT_UNROLLED_LIST_H
+#define CONCURRENT_UNROLLED_LIST_H
+
+#include "epoch_reclaimer.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <type_traits>
+
+// Unrolled list that many threads may read and write at once. Every node
+// carries a seqlock version whose odd values double as the node's lock.
+//
+// Readers never lock: they copy a node's elements and successor, then retry
+// if the version moved meanwhile, so each node is observed as one consistent
+// snapshot. Writers lock hand over hand from a sentinel head, holding at most
+// a node and its predecessor, and lock only the node itself to split it.
+// Unlinked nodes are retired to an epoch_reclaimer, so a reader still
+// standing on one never touches freed memory. Nodes are allocated with no
+// lock held: a writer that finds it needs one drops its locks, allocates a
+// spare and starts over, so a throwing allocation cannot leave a node locked.
+//
+// Elements live in std::atomic<T> slots, hence T must be trivially copyable.
+template <typename T, std::size_t NodeMaxSize = 32>
+class concurrent_unrolled_list
+{
+    static_assert(std::is_trivially_copyable<T>::value, "concurrent_unrolled_list requires a trivially copyable T");
+    static_assert(NodeMaxSize >= 2, "nodes must hold at least two elements");
+
+private:
+    struct Node
+    {
+        std::atomic<std::uint64_t> version{0};
+        std::atomic<Node *> next{nullptr};
+        std::atomic<std::size_t> count{0};
+        bool dead = false;
+        std::atomic<T> elements[NodeMaxSize]{};
+    };
+
+    Node *head;
+    std::atomic<Node *> tail;
+    std::atomic<std::size_t> list_size{0};
+    mutable epoch_reclaimer reclaimer;
+
+    static void backoff(unsigned &spins) noexcept
+    {
+        if (++spins > 64)
+            std::this_thread::yield();
+    }
+
+    static void lock(Node *node) noexcept
+    {
+        unsigned spins = 0;
+        std::uint64_t version = node->version.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            if (!(version & 1) && node->version.compare_exchange_weak(version, version + 1, std::memory_order_acquire,
+                                                                       std::memory_order_relaxed))
+                break;
+            backoff(spins);
+            version = node->version.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    static void unlock(Node *node) noexcept { node->version.fetch_add(1, std::memory_order_release); }
+
+    // Copies the elements and successor of node as of one version.
+    static std::size_t read_node(const Node *node, T *out, Node *&next) noexcept
+    {
+        unsigned spins = 0;
+        for (;;)
+        {
+            std::uint64_t version = node->version.load(std::memory_order_acquire);
+            if (!(version & 1))
+            {
+                std::size_t n = node->count.load(std::memory_order_relaxed);
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    out[i] = node->elements[i].load(std::memory_order_relaxed);
+                }
+                next = node->next.load(std::memory_order_acquire);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (node->version.load(std::memory_order_relaxed) == version)
+                    return n;
+            }
+            backoff(spins);
+        }
+    }
+
+    // The helpers below run with node locked.
+    static T get(const Node *node, std::size_t i) noexcept { return node->elements[i].load(std::memory_order_relaxed); }
+
+    static void set(Node *node, std::size_t i, const T &value) noexcept
+    {
+        node->elements[i].store(value, std::memory_order_relaxed);
+    }
+
+    static void insert_at(Node *node, std::size_t pos, const T &value) noexcept
+    {
+        std::size_t n = node->count.load(std::memory_order_relaxed);
+        for (std::size_t i = n; i > pos; --i)
+        {
+            set(node, i, get(node, i - 1));
+        }
+        set(node, pos, value);
+        node->count.store(n + 1, std::memory_order_relaxed);
+    }
+
+    // Moves the upper half of a full node into the spare, which is published
+    // as its successor only once it holds its elements.
+    Node *split_node(Node *node, std::unique_ptr<Node> &spare) noexcept
+    {
+        Node *fresh = spare.release();
+        std::size_t mid = NodeMaxSize / 2;
+        for (std::size_t i = mid; i < NodeMaxSize; ++i)
+        {
+            set(fresh, i - mid, get(node, i));
+        }
+        fresh->count.store(NodeMaxSize - mid, std::memory_order_relaxed);
+        fresh->next.store(node->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        node->count.store(mid, std::memory_order_relaxed);
+        node->next.store(fresh, std::memory_order_release);
+        if (tail.load(std::memory_order_relaxed) == node)
+            tail.store(fresh, std::memory_order_release);
+        return fresh;
+    }
+
+    // Links the spare, holding just value, after the locked node prev.
+    void link_new_node(Node *prev, const T &value, std::unique_ptr<Node> &spare) noexcept
+    {
+        Node *fresh = spare.release();
+        set(fresh, 0, value);
+        fresh->count.store(1, std::memory_order_relaxed);
+        fresh->next.store(prev->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        prev->next.store(fresh, std::memory_order_release);
+        if (tail.load(std::memory_order_relaxed) == prev)
+            tail.store(fresh, std::memory_order_release);
+    }
+
+    // One locked walk of insert_before. Returns false, with every lock
+    // released and nothing changed, if the insert needs a new node and no
+    // spare is at hand.
+    template <typename Pred>
+    bool try_insert_before(Pred &pred, const T &value, std::unique_ptr<Node> &spare)
+    {
+        lock(head);
+        Node *prev = head;
+        Node *node = head->next.load(std::memory_order_relaxed);
+        while (node)
+        {
+            lock(node);
+            unlock(prev);
+            std::size_t n = node->count.load(std::memory_order_relaxed);
+            std::size_t pos = 0;
+            while (pos < n && !pred(get(node, pos)))
+                ++pos;
+            if (pos < n)
+            {
+                if (n == NodeMaxSize && !spare)
+                {
+                    unlock(node);
+                    return false;
+                }
+                Node *upper = n == NodeMaxSize ? split_node(node, spare) : nullptr;
+                if (upper && pos > NodeMaxSize / 2)
+                {
+                    lock(upper);
+                    insert_at(upper, pos - NodeMaxSize / 2, value);
+                    unlock(upper);
+                }
+                else
+                {
+                    insert_at(node, pos, value);
+                }
+                unlock(node);
+                return true;
+            }
+            prev = node;
+            node = node->next.load(std::memory_order_relaxed);
+        }
+        std::size_t n = prev->count.load(std::memory_order_relaxed);
+        if (prev != head && n < NodeMaxSize)
+        {
+            insert_at(prev, n, value);
+        }
+        else if (spare)
+        {
+            link_new_node(prev, value, spare);
+        }
+        else
+        {
+            unlock(prev);
+            return false;
+        }
+        unlock(prev);
+        return true;
+    }
+
+    // Calls visit on every element until it returns true.
+    template <typename Visit>
+    bool scan(Visit visit) const
+    {
+        epoch_guard guard(reclaimer);
+        T buffer[NodeMaxSize];
+        Node *next = nullptr;
+        for (Node *node = head->next.load(std::memory_order_acquire); node; node = next)
+        {
+            std::size_t n = read_node(node, buffer, next);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (visit(static_cast<const T &>(buffer[i])))
+                    return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    static constexpr size_type node_capacity = NodeMaxSize;
+
+    concurrent_unrolled_list() : head(new Node()), tail(head) {}
+
+    concurrent_unrolled_list(const concurrent_unrolled_list &) = delete;
+    concurrent_unrolled_list &operator=(const concurrent_unrolled_list &) = delete;
+
+    // No other thread may use the list while it is destroyed.
+    ~concurrent_unrolled_list()
+    {
+        Node *node = head;
+        while (node)
+        {
+            Node *next = node->next.load(std::memory_order_relaxed);
+            delete node;
+            node = next;
+        }
+    }
+
+    // Exact once concurrent writers are done, a close estimate meanwhile.
+    size_type size() const noexcept { return list_size.load(std::memory_order_relaxed); }
+    bool empty() const noexcept { return size() == 0; }
+
+    void push_back(const T &value)
+    {
+        epoch_guard guard(reclaimer);
+        std::unique_ptr<Node> spare;
+        for (;;)
+        {
+            Node *last = tail.load(std::memory_order_acquire);
+            lock(last);
+            if (last->dead || last->next.load(std::memory_order_relaxed))
+            {
+                unlock(last);
+                continue;
+            }
+            std::size_t n = last->count.load(std::memory_order_relaxed);
+            if (last != head && n < NodeMaxSize)
+            {
+                set(last, n, value);
+                last->count.store(n + 1, std::memory_order_relaxed);
+            }
+            else if (spare)
+            {
+                link_new_node(last, value, spare);
+            }
+            else
+            {
+                unlock(last);
+                spare.reset(new Node());
+                continue;
+            }
+            unlock(last);
+            list_size.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    void push_front(const T &value)
+    {
+        epoch_guard guard(reclaimer);
+        std::unique_ptr<Node> spare;
+        for (;;)
+        {
+            lock(head);
+            Node *first = head->next.load(std::memory_order_relaxed);
+            if (first)
+                lock(first);
+            bool done = true;
+            if (first && first->count.load(std::memory_order_relaxed) < NodeMaxSize)
+                insert_at(first, 0, value);
+            else if (spare)
+                link_new_node(head, value, spare);
+            else
+                done = false;
+            if (first)
+                unlock(first);
+            unlock(head);
+            if (done)
+                break;
+            spare.reset(new Node());
+        }
+        list_size.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Inserts value before the first element satisfying pred, or at the
+    // back. As writers cannot overtake each other, concurrent inserts with
+    // an ordering predicate such as `x >= value` keep a sorted list sorted.
+    template <typename Pred>
+    void insert_before(Pred pred, const T &value)
+    {
+        epoch_guard guard(reclaimer);
+        std::unique_ptr<Node> spare;
+        while (!try_insert_before(pred, value, spare))
+            spare.reset(new Node());
+        list_size.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Removes every element satisfying pred and unlinks nodes left empty.
+    template <typename Pred>
+    size_type erase_if(Pred pred)
+    {
+        epoch_guard guard(reclaimer);
+        size_type removed = 0;
+        lock(head);
+        Node *prev = head;
+        Node *node = head->next.load(std::memory_order_relaxed);
+        while (node)
+        {
+            lock(node);
+            std::size_t n = node->count.load(std::memory_order_relaxed);
+            std::size_t kept = 0;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                T value = get(node, i);
+                if (!pred(value))
+                    set(node, kept++, value);
+            }
+            node->count.store(kept, std::memory_order_relaxed);
+            removed += n - kept;
+
+            Node *next = node->next.load(std::memory_order_relaxed);
+            if (kept == 0)
+            {
+                prev->next.store(next, std::memory_order_release);
+                if (tail.load(std::memory_order_relaxed) == node)
+                    tail.store(prev, std::memory_order_release);
+                node->dead = true;
+                unlock(node);
+                reclaimer.retire(node);
+            }
+            else
+            {
+                unlock(prev);
+                prev = node;
+            }
+            node = next;
+        }
+        unlock(prev);
+        list_size.fetch_sub(removed, std::memory_order_relaxed);
+        return removed;
+    }
+
+    size_type erase(const T &value)
+    {
+        return erase_if([&value](const T &x) { return x == value; });
+    }
+
+    void clear()
+    {
+        erase_if([](const T &) { return true; });
+    }
+
+    // Visits every element; each node is seen as of a single moment, and
+    // elements present for the whole call are visited exactly once.
+    template <typename F>
+    void for_each(F f) const
+    {
+        scan([&f](const T &x) {
+            f(x);
+            return false;
+        });
+    }
+
+    template <typename Pred>
+    std::optional<T> find_if(Pred pred) const
+    {
+        std::optional<T> found;
+        scan([&](const T &x) {
+            if (!pred(x))
+                return false;
+            found = x;
+            return true;
+        });
+        return found;
+    }
+
+    bool contains(const T &value) const
+    {
+        return scan([&value](const T &x) { return x == value; });
+    }
+
+    // Frees retired nodes no reader can still reach; returns how many wait.
+    size_type reclaim() { return reclaimer.reclaim(); }
+};
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef EPOCH_RECLAIMER_H
+#define EPOCH_RECLAIMER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Epoch-based reclamation. Readers bracket every access to shared nodes with
+// an epoch_guard; writers hand unlinked nodes to retire(). A node retired in
+// epoch e is freed once the epoch has advanced twice past it, which can only
+// happen after every guard entered in epoch e or earlier has left.
+//
+// Only two epochs are ever live: the epoch moves from e to e + 1 only when no
+// guard entered in e - 1 remains, so one reader counter per parity suffices.
+class epoch_reclaimer
+{
+private:
+    struct retired_node
+    {
+        std::uint64_t epoch;
+        void *node;
+        void (*release)(void *, void *);
+        void *context;
+    };
+
+    struct alignas(64) reader_count
+    {
+        std::atomic<std::size_t> value{0};
+    };
+
+    std::atomic<std::uint64_t> epoch{2};
+    reader_count readers[2];
+    std::mutex retired_mutex;
+    std::vector<retired_node> retired;
+
+    static constexpr std::size_t reclaim_threshold = 64;
+
+    // Called with retired_mutex held.
+    void try_advance()
+    {
+        std::uint64_t current = epoch.load(std::memory_order_seq_cst);
+        if (readers[(current - 1) & 1].value.load(std::memory_order_seq_cst) != 0)
+            return;
+        epoch.store(current + 1, std::memory_order_seq_cst);
+
+        std::size_t kept = 0;
+        for (retired_node &r : retired)
+        {
+            if (r.epoch < current)
+                r.release(r.context, r.node);
+            else
+                retired[kept++] = r;
+        }
+        retired.resize(kept);
+    }
+
+public:
+    epoch_reclaimer() = default;
+    epoch_reclaimer(const epoch_reclaimer &) = delete;
+    epoch_reclaimer &operator=(const epoch_reclaimer &) = delete;
+
+    // No guard may be active when the reclaimer is destroyed.
+    ~epoch_reclaimer()
+    {
+        for (retired_node &r : retired)
+        {
+            r.release(r.context, r.node);
+        }
+    }
+
+    std::uint64_t enter() noexcept
+    {
+        for (;;)
+        {
+            std::uint64_t e = epoch.load(std::memory_order_seq_cst);
+            readers[e & 1].value.fetch_add(1, std::memory_order_seq_cst);
+            if (epoch.load(std::memory_order_seq_cst) == e)
+                return e;
+            readers[e & 1].value.fetch_sub(1, std::memory_order_seq_cst);
+        }
+    }
+
+    void leave(std::uint64_t e) noexcept { readers[e & 1].value.fetch_sub(1, std::memory_order_seq_cst); }
+
+    template <typename Node>
+    void retire(Node *node)
+    {
+        retire(node, [](void *, void *p) { delete static_cast<Node *>(p); }, nullptr);
+    }
+
+    // Hands node to release(context, node) once it is safe, e.g. to return
+    // it to a pool instead of deleting it.
+    void retire(void *node, void (*release)(void *, void *), void *context)
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex);
+        retired.push_back({epoch.load(std::memory_order_seq_cst), node, release, context});
+        if (retired.size() >= reclaim_threshold)
+            try_advance();
+    }
+
+    // Frees whatever has become safe to free; returns how many nodes wait.
+    // Without active guards two advances free everything retired so far.
+    std::size_t reclaim()
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex);
+        try_advance();
+        try_advance();
+        return retired.size();
+    }
+};
+
+class epoch_guard
+{
+public:
+    explicit epoch_guard(epoch_reclaimer &reclaimer) noexcept : reclaimer(reclaimer), epoch(reclaimer.enter()) {}
+    ~epoch_guard() { reclaimer.leave(epoch); }
+
+    epoch_guard(const epoch_guard &) = delete;
+    epoch_guard &operator=(const epoch_guard &) = delete;
+
+private:
+    epoch_reclaimer &reclaimer;
+    std::uint64_t epoch;
+};
+
+#endif
@@ -0,0 +1,225 @@
+#ifndef MAPPED_UNROLLED_LIST_H
+#define MAPPED_UNROLLED_LIST_H
+
+#include "unrolled_list.h"
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read-only view of a file written by unrolled_list::save(). The file is
+// memory-mapped and iterated in place: opening costs one mmap and a pass
+// over the block counts to validate them, and elements are read straight
+// from the mapped blocks without copies or per-node allocations. POSIX only.
+template <typename T>
+class mapped_unrolled_list
+{
+    static_assert(std::is_trivially_copyable_v<T>, "mapped_unrolled_list requires a trivially copyable T");
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = const T &;
+    using const_reference = const T &;
+    using pointer = const T *;
+    using const_pointer = const T *;
+    using const_segment = typename unrolled_list<T>::const_segment;
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        const_iterator() noexcept = default;
+
+        reference operator*() const noexcept { return segment[index]; }
+        pointer operator->() const noexcept { return &segment[index]; }
+
+        const_iterator &operator++() noexcept
+        {
+            if (++index == segment.size())
+            {
+                index = 0;
+                while (++block < list->block_count() && (segment = list->block(block)).empty())
+                {
+                }
+                if (block == list->block_count())
+                    segment = const_segment(nullptr, 0);
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept
+        {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        bool operator==(const const_iterator &other) const noexcept
+        {
+            return segment.data() == other.segment.data() && index == other.index;
+        }
+        bool operator!=(const const_iterator &other) const noexcept { return !(*this == other); }
+
+    private:
+        friend class mapped_unrolled_list;
+
+        const_iterator(const mapped_unrolled_list *list, size_type block) noexcept
+            : list(list), block(block), segment(nullptr, 0)
+        {
+            for (; this->block < list->block_count(); ++this->block)
+            {
+                segment = list->block(this->block);
+                if (!segment.empty())
+                    return;
+            }
+            segment = const_segment(nullptr, 0);
+        }
+
+        const mapped_unrolled_list *list = nullptr;
+        size_type block = 0;
+        const_segment segment{nullptr, 0};
+        size_type index = 0;
+    };
+
+    using iterator = const_iterator;
+
+    explicit mapped_unrolled_list(const char *path)
+    {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("mapped_unrolled_list cannot open file");
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || static_cast<std::uint64_t>(info.st_size) < sizeof(header))
+        {
+            ::close(fd);
+            throw std::runtime_error("mapped_unrolled_list file has a different format");
+        }
+        length = static_cast<size_type>(info.st_size);
+        void *memory = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (memory == MAP_FAILED)
+            throw std::runtime_error("mapped_unrolled_list cannot map file");
+        base = static_cast<const std::byte *>(memory);
+
+        std::memcpy(&header, base, sizeof(header));
+        if (!header.holds<T>() || !header.spans(length))
+        {
+            unmap();
+            throw std::runtime_error("mapped_unrolled_list file has a different format");
+        }
+        if (!counts_match())
+        {
+            unmap();
+            throw std::runtime_error("mapped_unrolled_list file is corrupt");
+        }
+    }
+
+    mapped_unrolled_list(mapped_unrolled_list &&other) noexcept
+        : base(std::exchange(other.base, nullptr)), length(std::exchange(other.length, 0)), header(other.header)
+    {
+    }
+
+    mapped_unrolled_list &operator=(mapped_unrolled_list &&other) noexcept
+    {
+        if (this != &other)
+        {
+            unmap();
+            base = std::exchange(other.base, nullptr);
+            length = std::exchange(other.length, 0);
+            header = other.header;
+        }
+        return *this;
+    }
+
+    mapped_unrolled_list(const mapped_unrolled_list &) = delete;
+    mapped_unrolled_list &operator=(const mapped_unrolled_list &) = delete;
+
+    ~mapped_unrolled_list() { unmap(); }
+
+    size_type size() const noexcept { return base ? static_cast<size_type>(header.size) : 0; }
+    bool empty() const noexcept { return size() == 0; }
+    size_type block_count() const noexcept { return base ? static_cast<size_type>(header.block_count) : 0; }
+    size_type block_capacity() const noexcept { return static_cast<size_type>(header.block_capacity); }
+
+    // The elements of one saved node.
+    const_segment block(size_type index) const noexcept
+    {
+        const std::byte *start = base + header.data_offset() + index * header.block_stride();
+        return const_segment(reinterpret_cast<const T *>(start + header.payload_offset()),
+                             static_cast<size_type>(block_size(start)));
+    }
+
+    template <typename F>
+    void for_each_segment(F f) const
+    {
+        for (size_type b = 0; b < block_count(); ++b)
+        {
+            const_segment seg = block(b);
+            if (!seg.empty())
+                f(seg);
+        }
+    }
+
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    const_iterator end() const noexcept { return const_iterator(this, block_count()); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    // Copies the mapped elements into an ordinary list.
+    template <typename List = unrolled_list<T>>
+    List to_list() const
+    {
+        List list;
+        for_each_segment([&list](const_segment seg) { list.insert(list.cend(), seg.begin(), seg.end()); });
+        return list;
+    }
+
+private:
+    const std::byte *base = nullptr;
+    size_type length = 0;
+    unrolled_list_file_header header{};
+
+    static std::uint64_t block_size(const std::byte *start) noexcept
+    {
+        std::uint64_t count;
+        std::memcpy(&count, start, sizeof(count));
+        return count;
+    }
+
+    // Every block count fits its block and together they add up to size().
+    bool counts_match() const noexcept
+    {
+        std::uint64_t total = 0;
+        for (std::uint64_t b = 0; b < header.block_count; ++b)
+        {
+            std::uint64_t count = block_size(base + header.data_offset() + b * header.block_stride());
+            if (count > header.block_capacity)
+                return false;
+            total += count;
+        }
+        return total == header.size;
+    }
+
+    void unmap() noexcept
+    {
+        if (base)
+            ::munmap(const_cast<std::byte *>(base), length);
+        base = nullptr;
+    }
+};
+
+#endif
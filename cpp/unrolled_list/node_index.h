@@ -0,0 +1,216 @@
+#ifndef NODE_INDEX_H
+#define NODE_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+struct no_index_hook
+{
+};
+
+struct order_statistic_hook
+{
+    order_statistic_hook *parent = nullptr;
+    order_statistic_hook *left = nullptr;
+    order_statistic_hook *right = nullptr;
+    std::size_t own = 0;
+    std::size_t total = 0;
+    std::uint32_t priority = 0;
+};
+
+struct no_index
+{
+    void clear() noexcept {}
+};
+
+// Implicit treap over the node chain: in-order traversal follows the list,
+// and every hook caches the element count of its subtree.
+class order_statistic_index
+{
+private:
+    order_statistic_hook *root = nullptr;
+    std::uint32_t seed = 0x9E3779B9u;
+
+    static std::size_t total_of(const order_statistic_hook *h) noexcept { return h ? h->total : 0; }
+
+    static void pull(order_statistic_hook *h) noexcept
+    {
+        h->total = h->own + total_of(h->left) + total_of(h->right);
+    }
+
+    std::uint32_t next_priority() noexcept
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    }
+
+    void rotate_up(order_statistic_hook *h) noexcept
+    {
+        order_statistic_hook *p = h->parent;
+        order_statistic_hook *g = p->parent;
+        if (p->left == h)
+        {
+            p->left = h->right;
+            if (h->right)
+                h->right->parent = p;
+            h->right = p;
+        }
+        else
+        {
+            p->right = h->left;
+            if (h->left)
+                h->left->parent = p;
+            h->left = p;
+        }
+        p->parent = h;
+        h->parent = g;
+        if (!g)
+            root = h;
+        else if (g->left == p)
+            g->left = h;
+        else
+            g->right = h;
+        pull(p);
+        pull(h);
+    }
+
+public:
+    order_statistic_index() noexcept = default;
+    order_statistic_index(const order_statistic_index &) = delete;
+    order_statistic_index &operator=(const order_statistic_index &) = delete;
+
+    order_statistic_index(order_statistic_index &&other) noexcept : root(std::exchange(other.root, nullptr)), seed(other.seed) {}
+
+    order_statistic_index &operator=(order_statistic_index &&other) noexcept
+    {
+        root = std::exchange(other.root, nullptr);
+        seed = other.seed;
+        return *this;
+    }
+
+    void swap(order_statistic_index &other) noexcept
+    {
+        std::swap(root, other.root);
+        std::swap(seed, other.seed);
+    }
+
+    void clear() noexcept { root = nullptr; }
+
+    std::size_t size() const noexcept { return total_of(root); }
+
+    void insert_after(order_statistic_hook *pos, order_statistic_hook *h) noexcept
+    {
+        h->left = h->right = nullptr;
+        h->total = h->own;
+        h->priority = next_priority();
+        if (!root)
+        {
+            h->parent = nullptr;
+            root = h;
+            return;
+        }
+        order_statistic_hook *p;
+        if (!pos)
+        {
+            for (p = root; p->left; p = p->left)
+            {
+            }
+            p->left = h;
+        }
+        else if (!pos->right)
+        {
+            p = pos;
+            p->right = h;
+        }
+        else
+        {
+            for (p = pos->right; p->left; p = p->left)
+            {
+            }
+            p->left = h;
+        }
+        h->parent = p;
+        for (; p; p = p->parent)
+        {
+            p->total += h->own;
+        }
+        while (h->parent && h->parent->priority < h->priority)
+        {
+            rotate_up(h);
+        }
+    }
+
+    void erase(order_statistic_hook *h) noexcept
+    {
+        while (h->left || h->right)
+        {
+            order_statistic_hook *child = !h->right || (h->left && h->left->priority > h->right->priority) ? h->left : h->right;
+            rotate_up(child);
+        }
+        order_statistic_hook *p = h->parent;
+        if (!p)
+            root = nullptr;
+        else if (p->left == h)
+            p->left = nullptr;
+        else
+            p->right = nullptr;
+        for (; p; p = p->parent)
+        {
+            p->total -= h->own;
+        }
+        h->parent = nullptr;
+    }
+
+    void update(order_statistic_hook *h, std::size_t count) noexcept
+    {
+        if (h->own == count)
+            return;
+        std::size_t old = h->own;
+        h->own = count;
+        for (; h; h = h->parent)
+        {
+            h->total = h->total - old + count;
+        }
+    }
+
+    std::pair<order_statistic_hook *, std::size_t> find(std::size_t k) const noexcept
+    {
+        order_statistic_hook *h = root;
+        while (h)
+        {
+            std::size_t left_total = total_of(h->left);
+            if (k < left_total)
+            {
+                h = h->left;
+            }
+            else if (k < left_total + h->own)
+            {
+                return {h, k - left_total};
+            }
+            else
+            {
+                k -= left_total + h->own;
+                h = h->right;
+            }
+        }
+        return {nullptr, 0};
+    }
+
+    std::size_t rank(const order_statistic_hook *h) const noexcept
+    {
+        std::size_t r = total_of(h->left);
+        for (; h->parent; h = h->parent)
+        {
+            if (h->parent->right == h)
+            {
+                r += total_of(h->parent->left) + h->parent->own;
+            }
+        }
+        return r;
+    }
+};
+
+#endif
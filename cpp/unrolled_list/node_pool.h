@@ -0,0 +1,172 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Fixed-size block pool: blocks are carved out of slabs and recycled through
+// an intrusive free list. Not thread-safe; share one pool per thread.
+class node_pool
+{
+private:
+    struct free_block
+    {
+        free_block *next;
+    };
+
+    struct bucket
+    {
+        std::size_t size;
+        std::size_t alignment;
+        std::size_t block_size;
+        free_block *free_list;
+    };
+
+    struct slab
+    {
+        void *memory;
+        std::size_t alignment;
+    };
+
+    std::size_t blocks_per_slab;
+    std::vector<bucket> buckets;
+    std::vector<slab> slabs;
+
+    bucket &find_bucket(std::size_t size, std::size_t alignment)
+    {
+        for (bucket &b : buckets)
+        {
+            if (b.size == size && b.alignment == alignment)
+            {
+                return b;
+            }
+        }
+        std::size_t align = alignment < alignof(free_block) ? alignof(free_block) : alignment;
+        std::size_t block_size = size < sizeof(free_block) ? sizeof(free_block) : size;
+        block_size = (block_size + align - 1) / align * align;
+        buckets.push_back(bucket{size, alignment, block_size, nullptr});
+        return buckets.back();
+    }
+
+    void refill(bucket &b)
+    {
+        std::size_t align = b.alignment < alignof(free_block) ? alignof(free_block) : b.alignment;
+        slabs.reserve(slabs.size() + 1);
+        std::byte *memory = static_cast<std::byte *>(::operator new(b.block_size * blocks_per_slab, std::align_val_t(align)));
+        slabs.push_back(slab{memory, align});
+        for (std::size_t i = blocks_per_slab; i > 0; --i)
+        {
+            free_block *block = reinterpret_cast<free_block *>(memory + (i - 1) * b.block_size);
+            block->next = b.free_list;
+            b.free_list = block;
+        }
+    }
+
+public:
+    explicit node_pool(std::size_t blocks_per_slab) : blocks_per_slab(blocks_per_slab ? blocks_per_slab : 1) {}
+
+    node_pool(const node_pool &) = delete;
+    node_pool &operator=(const node_pool &) = delete;
+
+    ~node_pool()
+    {
+        for (const slab &s : slabs)
+        {
+            ::operator delete(s.memory, std::align_val_t(s.alignment));
+        }
+    }
+
+    void *allocate(std::size_t size, std::size_t alignment)
+    {
+        bucket &b = find_bucket(size, alignment);
+        if (!b.free_list)
+        {
+            refill(b);
+        }
+        free_block *block = b.free_list;
+        b.free_list = block->next;
+        return block;
+    }
+
+    void deallocate(void *p, std::size_t size, std::size_t alignment) noexcept
+    {
+        for (bucket &b : buckets)
+        {
+            if (b.size == size && b.alignment == alignment)
+            {
+                free_block *block = static_cast<free_block *>(p);
+                block->next = b.free_list;
+                b.free_list = block;
+                return;
+            }
+        }
+    }
+
+    std::size_t slab_count() const noexcept { return slabs.size(); }
+};
+
+// Allocator for unrolled_list: single-object requests (one Node at a time)
+// come from a shared node_pool, larger requests fall back to std::allocator.
+// Copies and rebinds share the pool, so every node returns to the free list
+// of the list that allocated it.
+template <typename T, std::size_t NodesPerSlab = 64>
+class pool_allocator
+{
+private:
+    std::shared_ptr<node_pool> pool;
+
+    template <typename U, std::size_t N>
+    friend class pool_allocator;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = pool_allocator<U, NodesPerSlab>;
+    };
+
+    pool_allocator() : pool(std::make_shared<node_pool>(NodesPerSlab)) {}
+    pool_allocator(const pool_allocator &other) noexcept = default;
+    pool_allocator &operator=(const pool_allocator &other) noexcept = default;
+
+    template <typename U>
+    pool_allocator(const pool_allocator<U, NodesPerSlab> &other) noexcept : pool(other.pool) {}
+
+    T *allocate(std::size_t n)
+    {
+        if (n == 1)
+        {
+            return static_cast<T *>(pool->allocate(sizeof(T), alignof(T)));
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept
+    {
+        if (n == 1)
+        {
+            pool->deallocate(p, sizeof(T), alignof(T));
+            return;
+        }
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    std::size_t slab_count() const noexcept { return pool->slab_count(); }
+
+    template <typename U>
+    bool operator==(const pool_allocator<U, NodesPerSlab> &other) const noexcept { return pool == other.pool; }
+
+    template <typename U>
+    bool operator!=(const pool_allocator<U, NodesPerSlab> &other) const noexcept { return pool != other.pool; }
+};
+
+#endif
@@ -0,0 +1,271 @@
+#ifndef PARALLEL_ALGORITHMS_H
+#define PARALLEL_ALGORITHMS_H
+
+#include "thread_pool.h"
+#include "unrolled_list.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+// Parallel algorithms over an unrolled_list with contiguous node storage.
+// The node chain is cut into runs of whole nodes holding roughly the same
+// number of elements, so sparse and full nodes balance out, and the runs
+// are handed to a thread_pool. Several runs go to each worker so that idle
+// workers can steal.
+
+enum class reduction_order
+{
+    unordered,
+    ordered
+};
+
+template <typename SegmentIterator>
+struct segment_chunk
+{
+    SegmentIterator first;
+    std::size_t segments;
+};
+
+template <typename List>
+auto partition_segments(List &list, std::size_t chunk_count)
+{
+    using segment_iterator = decltype(list.segments().begin());
+    std::vector<segment_chunk<segment_iterator>> chunks;
+    if (list.empty())
+        return chunks;
+    if (chunk_count == 0)
+        chunk_count = 1;
+    std::size_t target = (list.size() + chunk_count - 1) / chunk_count;
+    std::size_t filled = 0;
+    for (auto it = list.segments().begin(), end = list.segments().end(); it != end; ++it)
+    {
+        if (filled == 0)
+            chunks.push_back({it, 0});
+        ++chunks.back().segments;
+        filled += (*it).size();
+        if (filled >= target)
+            filled = 0;
+    }
+    return chunks;
+}
+
+template <typename List>
+std::size_t default_chunk_count(const thread_pool &pool, const List &)
+{
+    return pool.size() * 4;
+}
+
+// Calls f(segment) for every node segment of the chunk.
+template <typename Chunk, typename F>
+void for_each_chunk_segment(const Chunk &chunk, F &&f)
+{
+    auto it = chunk.first;
+    for (std::size_t i = 0; i < chunk.segments; ++i, ++it)
+    {
+        f(*it);
+    }
+}
+
+template <typename List, typename F>
+void parallel_for_each(thread_pool &pool, List &list, F f)
+{
+    auto chunks = partition_segments(list, default_chunk_count(pool, list));
+    pool.run(chunks.size(), [&](std::size_t c) {
+        for_each_chunk_segment(chunks[c], [&](auto seg) {
+            for (auto &value : seg)
+                f(value);
+        });
+    });
+}
+
+// In-place transform: every element is replaced by op(element).
+template <typename List, typename UnaryOp>
+void parallel_transform(thread_pool &pool, List &list, UnaryOp op)
+{
+    auto chunks = partition_segments(list, default_chunk_count(pool, list));
+    pool.run(chunks.size(), [&](std::size_t c) {
+        for_each_chunk_segment(chunks[c], [&](auto seg) {
+            for (auto &value : seg)
+                value = op(value);
+        });
+    });
+}
+
+// Folds each chunk from its first element, then folds the partial results
+// into init. `ordered` combines them in list order, which makes the result
+// reproducible for a given pool size; `unordered` combines them as they
+// finish.
+template <typename List, typename T, typename BinaryOp>
+T parallel_reduce(thread_pool &pool, const List &list, T init, BinaryOp op,
+                  reduction_order order = reduction_order::unordered)
+{
+    auto chunks = partition_segments(list, default_chunk_count(pool, list));
+    std::vector<std::optional<T>> partials(order == reduction_order::ordered ? chunks.size() : 0);
+    std::mutex combine_mutex;
+    pool.run(chunks.size(), [&](std::size_t c) {
+        std::optional<T> acc;
+        for_each_chunk_segment(chunks[c], [&](auto seg) {
+            for (const auto &value : seg)
+            {
+                if (acc)
+                    acc = op(std::move(*acc), value);
+                else
+                    acc.emplace(value);
+            }
+        });
+        if (order == reduction_order::ordered)
+        {
+            partials[c] = std::move(acc);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(combine_mutex);
+        init = op(std::move(init), std::move(*acc));
+    });
+    for (std::optional<T> &partial : partials)
+    {
+        init = op(std::move(init), std::move(*partial));
+    }
+    return init;
+}
+
+template <typename List, typename Predicate>
+std::size_t parallel_count_if(thread_pool &pool, const List &list, Predicate pred)
+{
+    auto chunks = partition_segments(list, default_chunk_count(pool, list));
+    std::atomic<std::size_t> total{0};
+    pool.run(chunks.size(), [&](std::size_t c) {
+        std::size_t count = 0;
+        for_each_chunk_segment(chunks[c], [&](auto seg) {
+            for (const auto &value : seg)
+                count += pred(value) ? 1 : 0;
+        });
+        total.fetch_add(count, std::memory_order_relaxed);
+    });
+    return total.load(std::memory_order_relaxed);
+}
+
+// Returns the first matching element in list order. Chunks after the
+// earliest match found so far stop scanning at their next node.
+template <typename List, typename Predicate>
+auto parallel_find_if(thread_pool &pool, List &list, Predicate pred)
+{
+    using iterator = decltype(list.begin());
+    using traits = segmented_iterator_traits<iterator>;
+    constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+
+    auto chunks = partition_segments(list, default_chunk_count(pool, list));
+    std::vector<iterator> hits(chunks.size(), list.end());
+    std::atomic<std::size_t> first_hit{none};
+    pool.run(chunks.size(), [&](std::size_t c) {
+        auto it = chunks[c].first;
+        for (std::size_t i = 0; i < chunks[c].segments && first_hit.load(std::memory_order_relaxed) > c; ++i, ++it)
+        {
+            auto seg = *it;
+            for (auto p = seg.begin(); p != seg.end(); ++p)
+            {
+                if (pred(*p))
+                {
+                    hits[c] = traits::compose(it, p);
+                    std::size_t seen = first_hit.load(std::memory_order_relaxed);
+                    while (c < seen && !first_hit.compare_exchange_weak(seen, c, std::memory_order_relaxed))
+                    {
+                    }
+                    return;
+                }
+            }
+        }
+    });
+    std::size_t hit = first_hit.load(std::memory_order_relaxed);
+    return hit == none ? list.end() : hits[hit];
+}
+
+// Cuts the list into one piece per worker, sorts the pieces concurrently
+// with the member sort, then merges neighbouring pieces pairwise, again in
+// parallel. Pieces allocate from copies of the list's allocator on several
+// threads at once, so the allocator must tolerate that (node_pool does not).
+template <typename List, typename Compare>
+void parallel_sort_pieces(thread_pool &pool, List &list, Compare comp, bool stable)
+{
+    auto chunks = partition_segments(list, pool.size());
+    if (chunks.size() <= 1)
+    {
+        if (stable)
+            list.stable_sort(comp);
+        else
+            list.sort(comp);
+        return;
+    }
+
+    // Chunks start at element offsets rather than nodes: split_at may move
+    // the list's inline node to the heap, and a chunk could start there.
+    std::vector<std::size_t> starts;
+    std::size_t offset = 0;
+    for (const auto &chunk : chunks)
+    {
+        starts.push_back(offset);
+        auto it = chunk.first;
+        for (std::size_t i = 0; i < chunk.segments; ++i, ++it)
+            offset += (*it).size();
+    }
+
+    std::vector<List> pieces;
+    pieces.reserve(chunks.size());
+    bool in_order = false;
+    try
+    {
+        for (std::size_t c = starts.size() - 1; c > 0; --c)
+        {
+            pieces.push_back(list.split_at(list.iterator_at(starts[c])));
+        }
+        pieces.push_back(std::move(list));
+        std::reverse(pieces.begin(), pieces.end());
+        in_order = true;
+
+        pool.run(pieces.size(), [&](std::size_t i) {
+            if (stable)
+                pieces[i].stable_sort(comp);
+            else
+                pieces[i].sort(comp);
+        });
+        for (std::size_t width = 1; width < pieces.size(); width *= 2)
+        {
+            pool.run((pieces.size() + 2 * width - 1) / (2 * width), [&](std::size_t pair) {
+                std::size_t left = pair * 2 * width;
+                if (left + width < pieces.size())
+                    pieces[left].merge(pieces[left + width], comp);
+            });
+        }
+        list = std::move(pieces.front());
+    }
+    catch (...)
+    {
+        // Pieces are split off back to front and stay behind what is left
+        // of the list until they are reversed; splice them back in order.
+        if (!in_order)
+            std::reverse(pieces.begin(), pieces.end());
+        for (List &piece : pieces)
+        {
+            list.splice(list.cend(), piece);
+        }
+        throw;
+    }
+}
+
+template <typename List, typename Compare = std::less<>>
+void parallel_sort(thread_pool &pool, List &list, Compare comp = Compare())
+{
+    parallel_sort_pieces(pool, list, comp, false);
+}
+
+template <typename List, typename Compare = std::less<>>
+void parallel_stable_sort(thread_pool &pool, List &list, Compare comp = Compare())
+{
+    parallel_sort_pieces(pool, list, comp, true);
+}
+
+#endif
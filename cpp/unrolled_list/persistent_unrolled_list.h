@@ -0,0 +1,563 @@
+#ifndef PERSISTENT_UNROLLED_LIST_H
+#define PERSISTENT_UNROLLED_LIST_H
+
+#include "static_array.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Unrolled list with copy-on-write versions. Elements live in reference
+// counted nodes, nodes in reference counted chunks of up to chunk_capacity
+// node pointers, and chunks in a root table. Copying a list or taking a
+// snapshot() shares the root and costs O(1). The first write to a shared
+// version clones the path to the touched element: the root table, one chunk
+// and one node. Everything else stays shared, so memory grows with what
+// changed, not with the size of the list.
+//
+// Distinct versions may be read and written from different threads; a
+// single version is no more thread-safe than any other container.
+template <typename T, std::size_t NodeMaxSize = 64>
+class persistent_unrolled_list
+{
+public:
+    static constexpr std::size_t node_capacity = NodeMaxSize;
+    static constexpr std::size_t chunk_capacity = 64;
+
+private:
+    struct Node
+    {
+        std::atomic<std::size_t> refs{1};
+        StaticArray<T, NodeMaxSize> elements;
+    };
+
+    struct Chunk
+    {
+        std::atomic<std::size_t> refs{1};
+        std::size_t size = 0;
+        StaticArray<Node *, chunk_capacity> nodes;
+    };
+
+    struct Root
+    {
+        std::atomic<std::size_t> refs{1};
+        std::vector<Chunk *> chunks;
+    };
+
+    struct position
+    {
+        std::size_t chunk;
+        std::size_t node;
+        std::size_t offset;
+    };
+
+    Root *root = nullptr;
+    std::size_t list_size = 0;
+
+    template <typename U>
+    static U *share(U *p) noexcept
+    {
+        p->refs.fetch_add(1, std::memory_order_relaxed);
+        return p;
+    }
+
+    template <typename U>
+    static bool unique(const U *p) noexcept
+    {
+        return p->refs.load(std::memory_order_acquire) == 1;
+    }
+
+    static void release(Node *node) noexcept
+    {
+        if (node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete node;
+    }
+
+    static void release(Chunk *chunk) noexcept
+    {
+        if (chunk->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            for (Node *node : chunk->nodes)
+            {
+                release(node);
+            }
+            delete chunk;
+        }
+    }
+
+    static void release(Root *root) noexcept
+    {
+        if (root && root->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            for (Chunk *chunk : root->chunks)
+            {
+                release(chunk);
+            }
+            delete root;
+        }
+    }
+
+    // The own() helpers replace a shared object by a private clone whose
+    // children are shared, so the caller may modify it in place.
+    Root *own_root()
+    {
+        if (!root)
+        {
+            root = new Root();
+        }
+        else if (!unique(root))
+        {
+            Root *copy = new Root();
+            try
+            {
+                copy->chunks = root->chunks;
+            }
+            catch (...)
+            {
+                delete copy;
+                throw;
+            }
+            for (Chunk *chunk : copy->chunks)
+            {
+                share(chunk);
+            }
+            release(root);
+            root = copy;
+        }
+        return root;
+    }
+
+    static Chunk *own(Chunk *&chunk)
+    {
+        if (!unique(chunk))
+        {
+            Chunk *copy = new Chunk();
+            copy->size = chunk->size;
+            for (Node *node : chunk->nodes)
+            {
+                copy->nodes.push_back(share(node));
+            }
+            release(chunk);
+            chunk = copy;
+        }
+        return chunk;
+    }
+
+    static Node *own(Node *&node)
+    {
+        if (!unique(node))
+        {
+            std::unique_ptr<Node> copy(new Node());
+            for (const T &item : node->elements)
+            {
+                copy->elements.push_back(item);
+            }
+            release(node);
+            node = copy.release();
+        }
+        return node;
+    }
+
+    // The node holding index, or the end of the last node for size().
+    position locate(std::size_t index) const noexcept
+    {
+        const std::vector<Chunk *> &chunks = root->chunks;
+        if (index == list_size)
+        {
+            const Chunk *last = chunks.back();
+            return position{chunks.size() - 1, last->nodes.size() - 1, last->nodes.back()->elements.size()};
+        }
+        std::size_t c = 0;
+        while (index >= chunks[c]->size)
+        {
+            index -= chunks[c]->size;
+            ++c;
+        }
+        const Chunk *chunk = chunks[c];
+        std::size_t n = 0;
+        while (index >= chunk->nodes[n]->elements.size())
+        {
+            index -= chunk->nodes[n]->elements.size();
+            ++n;
+        }
+        return position{c, n, index};
+    }
+
+    void collect_nodes(std::vector<const Node *> &out) const
+    {
+        for (std::size_t c = 0; root && c < root->chunks.size(); ++c)
+        {
+            for (const Node *node : root->chunks[c]->nodes)
+            {
+                out.push_back(node);
+            }
+        }
+    }
+
+    // Moves nodes [at, chunk_capacity) into a new chunk after index.
+    Chunk *split_chunk(Root *r, std::size_t index, std::size_t at)
+    {
+        Chunk *chunk = r->chunks[index];
+        std::unique_ptr<Chunk> upper(new Chunk());
+        for (std::size_t i = at; i < chunk_capacity; ++i)
+        {
+            upper->nodes.push_back(chunk->nodes[i]);
+            upper->size += chunk->nodes[i]->elements.size();
+        }
+        r->chunks.insert(r->chunks.begin() + static_cast<std::ptrdiff_t>(index) + 1, upper.get());
+        chunk->nodes.erase(at, chunk_capacity);
+        chunk->size -= upper->size;
+        return upper.release();
+    }
+
+    // A new node holding the elements [keep, NodeMaxSize) of a full node.
+    static Node *split_node(Node *node, std::size_t keep)
+    {
+        std::unique_ptr<Node> upper(new Node());
+        for (std::size_t i = keep; i < NodeMaxSize; ++i)
+        {
+            upper->elements.push_back(std::move(node->elements[i]));
+        }
+        node->elements.erase(keep, NodeMaxSize);
+        return upper.release();
+    }
+
+    // Folds an underfull node or chunk into its right neighbour's contents
+    // when both fit in one.
+    void merge_node(Chunk *chunk, std::size_t index)
+    {
+        Node *node = chunk->nodes[index];
+        if (node->elements.size() >= NodeMaxSize / 4 || index + 1 >= chunk->nodes.size())
+            return;
+        Node *next = chunk->nodes[index + 1];
+        if (node->elements.size() + next->elements.size() > NodeMaxSize)
+            return;
+        bool steal = unique(next);
+        for (T &item : next->elements)
+        {
+            if (steal)
+                node->elements.push_back(std::move(item));
+            else
+                node->elements.push_back(static_cast<const T &>(item));
+        }
+        chunk->nodes.erase(index + 1);
+        release(next);
+    }
+
+    void merge_chunk(Root *r, std::size_t index)
+    {
+        Chunk *chunk = r->chunks[index];
+        if (chunk->nodes.size() >= chunk_capacity / 4 || index + 1 >= r->chunks.size())
+            return;
+        Chunk *next = r->chunks[index + 1];
+        if (chunk->nodes.size() + next->nodes.size() > chunk_capacity)
+            return;
+        for (Node *node : next->nodes)
+        {
+            chunk->nodes.push_back(share(node));
+        }
+        chunk->size += next->size;
+        r->chunks.erase(r->chunks.begin() + static_cast<std::ptrdiff_t>(index) + 1);
+        release(next);
+    }
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = const T &;
+    using const_reference = const T &;
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        const_iterator() noexcept = default;
+
+        reference operator*() const noexcept { return node->elements[index]; }
+        pointer operator->() const noexcept { return &node->elements[index]; }
+
+        const_iterator &operator++() noexcept
+        {
+            if (++index == node->elements.size())
+            {
+                index = 0;
+                if (++node_pos == root->chunks[chunk_pos]->nodes.size())
+                {
+                    node_pos = 0;
+                    ++chunk_pos;
+                }
+                node = chunk_pos < root->chunks.size() ? root->chunks[chunk_pos]->nodes[node_pos] : nullptr;
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept
+        {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        bool operator==(const const_iterator &other) const noexcept { return node == other.node && index == other.index; }
+        bool operator!=(const const_iterator &other) const noexcept { return !(*this == other); }
+
+    private:
+        friend class persistent_unrolled_list;
+
+        const_iterator(const Root *root, size_type chunk_pos, size_type node_pos, size_type index) noexcept
+            : root(root), node(root->chunks[chunk_pos]->nodes[node_pos]), chunk_pos(chunk_pos), node_pos(node_pos),
+              index(index)
+        {
+        }
+
+        const Root *root = nullptr;
+        const Node *node = nullptr;
+        size_type chunk_pos = 0;
+        size_type node_pos = 0;
+        size_type index = 0;
+    };
+
+    using iterator = const_iterator;
+
+    persistent_unrolled_list() noexcept = default;
+
+    template <typename InputIt,
+              typename = std::enable_if_t<std::is_base_of_v<std::input_iterator_tag,
+                                                            typename std::iterator_traits<InputIt>::iterator_category>>>
+    persistent_unrolled_list(InputIt first, InputIt last)
+    {
+        for (; first != last; ++first)
+        {
+            push_back(*first);
+        }
+    }
+
+    persistent_unrolled_list(const persistent_unrolled_list &other) noexcept
+        : root(other.root ? share(other.root) : nullptr), list_size(other.list_size)
+    {
+    }
+
+    persistent_unrolled_list(persistent_unrolled_list &&other) noexcept
+        : root(std::exchange(other.root, nullptr)), list_size(std::exchange(other.list_size, 0))
+    {
+    }
+
+    persistent_unrolled_list &operator=(const persistent_unrolled_list &other) noexcept
+    {
+        persistent_unrolled_list(other).swap(*this);
+        return *this;
+    }
+
+    persistent_unrolled_list &operator=(persistent_unrolled_list &&other) noexcept
+    {
+        persistent_unrolled_list(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~persistent_unrolled_list() { release(root); }
+
+    // An O(1) version that later writes to either list leave untouched.
+    persistent_unrolled_list snapshot() const noexcept { return *this; }
+
+    size_type size() const noexcept { return list_size; }
+    bool empty() const noexcept { return list_size == 0; }
+
+    const_iterator begin() const noexcept { return list_size ? const_iterator(root, 0, 0, 0) : const_iterator(); }
+    const_iterator end() const noexcept { return const_iterator(); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    const_reference operator[](size_type index) const noexcept
+    {
+        position pos = locate(index);
+        return root->chunks[pos.chunk]->nodes[pos.node]->elements[pos.offset];
+    }
+
+    const_reference at(size_type index) const
+    {
+        if (index >= list_size)
+            throw std::out_of_range("persistent_unrolled_list index out of range");
+        return (*this)[index];
+    }
+
+    const_reference front() const noexcept { return root->chunks.front()->nodes.front()->elements.front(); }
+    const_reference back() const noexcept { return root->chunks.back()->nodes.back()->elements.back(); }
+
+    void set(size_type index, const T &value)
+    {
+        if (index >= list_size)
+            throw std::out_of_range("persistent_unrolled_list index out of range");
+        T copy(value);
+        position pos = locate(index);
+        Chunk *chunk = own(own_root()->chunks[pos.chunk]);
+        own(chunk->nodes[pos.node])->elements[pos.offset] = std::move(copy);
+    }
+
+    template <typename... Args>
+    void emplace(size_type index, Args &&...args)
+    {
+        if (index > list_size)
+            throw std::out_of_range("persistent_unrolled_list index out of range");
+        T value(std::forward<Args>(args)...);
+        Root *r = own_root();
+        if (r->chunks.empty())
+        {
+            std::unique_ptr<Chunk> chunk(new Chunk());
+            std::unique_ptr<Node> node(new Node());
+            node->elements.push_back(std::move(value));
+            chunk->nodes.push_back(node.release());
+            chunk->size = 1;
+            r->chunks.push_back(chunk.get());
+            chunk.release();
+            list_size = 1;
+            return;
+        }
+
+        position pos = locate(index);
+        Chunk *chunk = own(r->chunks[pos.chunk]);
+        Node *node = own(chunk->nodes[pos.node]);
+        if (node->elements.full())
+        {
+            // Appending to a full node starts an empty one instead of
+            // splitting, so sequential push_back fills nodes completely.
+            std::size_t keep = pos.offset == NodeMaxSize ? NodeMaxSize : NodeMaxSize / 2;
+            std::size_t slot = pos.node + 1;
+            Chunk *target = chunk;
+            if (chunk->nodes.full())
+            {
+                std::size_t at = keep == NodeMaxSize && slot == chunk_capacity ? chunk_capacity : chunk_capacity / 2;
+                Chunk *upper = split_chunk(r, pos.chunk, at);
+                if (pos.node >= at)
+                    chunk = upper;
+                if (slot >= at)
+                {
+                    target = upper;
+                    slot -= at;
+                }
+            }
+            Node *fresh = split_node(node, keep);
+            target->nodes.insert(slot, fresh);
+            chunk->size -= NodeMaxSize - keep;
+            target->size += NodeMaxSize - keep;
+            if (pos.offset >= keep)
+            {
+                node = fresh;
+                chunk = target;
+                pos.offset -= keep;
+            }
+        }
+        node->elements.insert(pos.offset, std::move(value));
+        ++chunk->size;
+        ++list_size;
+    }
+
+    void insert(size_type index, const T &value) { emplace(index, value); }
+    void insert(size_type index, T &&value) { emplace(index, std::move(value)); }
+    void push_back(const T &value) { emplace(list_size, value); }
+    void push_back(T &&value) { emplace(list_size, std::move(value)); }
+    void push_front(const T &value) { emplace(0, value); }
+    void push_front(T &&value) { emplace(0, std::move(value)); }
+
+    void erase(size_type index)
+    {
+        if (index >= list_size)
+            throw std::out_of_range("persistent_unrolled_list index out of range");
+        position pos = locate(index);
+        Root *r = own_root();
+        Chunk *chunk = own(r->chunks[pos.chunk]);
+        Node *node = own(chunk->nodes[pos.node]);
+        node->elements.erase(pos.offset);
+        --chunk->size;
+        --list_size;
+
+        if (node->elements.empty())
+        {
+            chunk->nodes.erase(pos.node);
+            release(node);
+        }
+        else
+        {
+            merge_node(chunk, pos.node);
+        }
+        if (chunk->nodes.empty())
+        {
+            r->chunks.erase(r->chunks.begin() + static_cast<std::ptrdiff_t>(pos.chunk));
+            release(chunk);
+        }
+        else
+        {
+            merge_chunk(r, pos.chunk);
+        }
+        if (!list_size)
+            clear();
+    }
+
+    void pop_back() { erase(list_size - 1); }
+    void pop_front() { erase(0); }
+
+    void clear() noexcept
+    {
+        release(root);
+        root = nullptr;
+        list_size = 0;
+    }
+
+    void swap(persistent_unrolled_list &other) noexcept
+    {
+        std::swap(root, other.root);
+        std::swap(list_size, other.list_size);
+    }
+
+    size_type node_count() const noexcept
+    {
+        size_type count = 0;
+        for (size_type c = 0; root && c < root->chunks.size(); ++c)
+        {
+            count += root->chunks[c]->nodes.size();
+        }
+        return count;
+    }
+
+    // Nodes of this version that other references as well.
+    size_type shared_node_count(const persistent_unrolled_list &other) const
+    {
+        std::vector<const Node *> mine;
+        std::vector<const Node *> theirs;
+        collect_nodes(mine);
+        other.collect_nodes(theirs);
+        std::sort(mine.begin(), mine.end());
+        std::sort(theirs.begin(), theirs.end());
+        std::vector<const Node *> common;
+        std::set_intersection(mine.begin(), mine.end(), theirs.begin(), theirs.end(), std::back_inserter(common));
+        return common.size();
+    }
+
+    bool operator==(const persistent_unrolled_list &other) const
+    {
+        if (list_size != other.list_size)
+            return false;
+        if (root == other.root)
+            return true;
+        for (const_iterator a = begin(), b = other.begin(); a != end(); ++a, ++b)
+        {
+            if (*a != *b)
+                return false;
+        }
+        return true;
+    }
+
+    bool operator!=(const persistent_unrolled_list &other) const { return !(*this == other); }
+};
+
+#endif
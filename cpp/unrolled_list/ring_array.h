@@ -0,0 +1,563 @@
+#ifndef RING_ARRAY_H
+#define RING_ARRAY_H
+
+#include <iterator>
+#include <stdexcept>
+#include <new>
+#include <memory>
+#include <utility>
+#include <cstring>
+#include <type_traits>
+
+template <typename T, size_t NodeMaxSize>
+class RingArray
+{
+private:
+    size_t first;
+    size_t count;
+    alignas(alignof(T)) std::byte elements[NodeMaxSize * sizeof(T)];
+
+    size_t slot(size_t index) const noexcept
+    {
+        size_t pos = first + index;
+        return pos >= NodeMaxSize ? pos - NodeMaxSize : pos;
+    }
+
+    // Copies other's elements into this empty array, unwrapped to start at
+    // slot 0.
+    void copy_from(const RingArray &other)
+    {
+        first = 0;
+        other.for_each_segment([this](const T *data, size_t n) {
+            if constexpr (std::is_trivially_copyable_v<T>)
+                std::memcpy(&elements[count * sizeof(T)], data, n * sizeof(T));
+            else
+                std::uninitialized_copy(data, data + n, reinterpret_cast<T *>(&elements[count * sizeof(T)]));
+            count += n;
+        });
+    }
+
+    void *raw_ptr(size_t index) noexcept
+    {
+        return &elements[slot(index) * sizeof(T)];
+    }
+
+    T *element_ptr(size_t index) noexcept
+    {
+        return std::launder(reinterpret_cast<T *>(&elements[slot(index) * sizeof(T)]));
+    }
+
+    const T *element_ptr(size_t index) const noexcept
+    {
+        return std::launder(reinterpret_cast<const T *>(&elements[slot(index) * sizeof(T)]));
+    }
+
+    void first_slot_back(size_t n) noexcept
+    {
+        first = first >= n ? first - n : first + NodeMaxSize - n;
+    }
+
+    void first_slot_forward(size_t n) noexcept
+    {
+        first = first + n >= NodeMaxSize ? first + n - NodeMaxSize : first + n;
+    }
+
+    void relocate(size_t from, size_t to)
+    {
+        new (raw_ptr(to)) T(std::move(*element_ptr(from)));
+        element_ptr(from)->~T();
+    }
+
+public:
+    using value_type = T;
+    using reference = T &;
+    using const_reference = const T &;
+    using pointer = T *;
+    using const_pointer = const T *;
+
+    class iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T *;
+        using reference = T &;
+
+        iterator(RingArray *array, size_t ind) : array_(array), ind_(ind) {}
+
+        reference operator*() const { return *array_->element_ptr(ind_); }
+        pointer operator->() const { return array_->element_ptr(ind_); }
+
+        iterator &operator++()
+        {
+            ++ind_;
+            return *this;
+        }
+        iterator operator++(int)
+        {
+            iterator temp = *this;
+            ++ind_;
+            return temp;
+        }
+        iterator &operator--()
+        {
+            --ind_;
+            return *this;
+        }
+        iterator operator--(int)
+        {
+            iterator temp = *this;
+            --ind_;
+            return temp;
+        }
+
+        bool operator==(const iterator &other) const { return array_ == other.array_ && ind_ == other.ind_; }
+        bool operator!=(const iterator &other) const { return !(*this == other); }
+        bool operator<(const iterator &other) const { return ind_ < other.ind_; }
+        bool operator>(const iterator &other) const { return ind_ > other.ind_; }
+        bool operator<=(const iterator &other) const { return ind_ <= other.ind_; }
+        bool operator>=(const iterator &other) const { return ind_ >= other.ind_; }
+        difference_type operator-(const iterator &other) const { return ind_ - other.ind_; }
+
+        iterator &operator+=(difference_type n)
+        {
+            ind_ += n;
+            return *this;
+        }
+        iterator &operator-=(difference_type n)
+        {
+            ind_ -= n;
+            return *this;
+        }
+        iterator operator+(difference_type n) const { return iterator(array_, ind_ + n); }
+        iterator operator-(difference_type n) const { return iterator(array_, ind_ - n); }
+        friend iterator operator+(difference_type n, const iterator &it) { return it + n; }
+        reference operator[](difference_type n) const { return *array_->element_ptr(ind_ + n); }
+
+    private:
+        RingArray *array_;
+        size_t ind_;
+        friend class RingArray;
+    };
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        const_iterator(const RingArray *array, size_t idx) : array_(array), ind_(idx) {}
+        const_iterator(const iterator &it) : array_(it.array_), ind_(it.ind_) {}
+
+        reference operator*() const { return *array_->element_ptr(ind_); }
+        pointer operator->() const { return array_->element_ptr(ind_); }
+
+        const_iterator &operator++()
+        {
+            ++ind_;
+            return *this;
+        }
+        const_iterator operator++(int)
+        {
+            const_iterator tmp = *this;
+            ++ind_;
+            return tmp;
+        }
+        const_iterator &operator--()
+        {
+            --ind_;
+            return *this;
+        }
+        const_iterator operator--(int)
+        {
+            const_iterator tmp = *this;
+            --ind_;
+            return tmp;
+        }
+
+        bool operator==(const const_iterator &other) const { return array_ == other.array_ && ind_ == other.ind_; }
+        bool operator!=(const const_iterator &other) const { return !(*this == other); }
+        bool operator<(const const_iterator &other) const { return ind_ < other.ind_; }
+        bool operator>(const const_iterator &other) const { return ind_ > other.ind_; }
+        bool operator<=(const const_iterator &other) const { return ind_ <= other.ind_; }
+        bool operator>=(const const_iterator &other) const { return ind_ >= other.ind_; }
+        difference_type operator-(const const_iterator &other) const { return ind_ - other.ind_; }
+
+        const_iterator &operator+=(difference_type n)
+        {
+            ind_ += n;
+            return *this;
+        }
+        const_iterator &operator-=(difference_type n)
+        {
+            ind_ -= n;
+            return *this;
+        }
+        const_iterator operator+(difference_type n) const { return const_iterator(array_, ind_ + n); }
+        const_iterator operator-(difference_type n) const { return const_iterator(array_, ind_ - n); }
+        friend const_iterator operator+(difference_type n, const const_iterator &it) { return it + n; }
+        reference operator[](difference_type n) const { return *array_->element_ptr(ind_ + n); }
+
+    private:
+        const RingArray *array_;
+        size_t ind_;
+        friend class RingArray;
+    };
+
+    RingArray() : first(0), count(0)
+    {
+        static_assert(NodeMaxSize > 0, "RingArray capacity must be greater than 0");
+    }
+
+    RingArray(const RingArray &other) : first(0), count(0)
+    {
+        copy_from(other);
+    }
+
+    RingArray &operator=(const RingArray &other)
+    {
+        if (this != &other)
+        {
+            clear();
+            copy_from(other);
+        }
+        return *this;
+    }
+
+    ~RingArray()
+    {
+        clear();
+    }
+
+    void push_back(const T &value)
+    {
+        emplace_back(value);
+    }
+
+    void push_back(T &&value)
+    {
+        emplace_back(std::move(value));
+    }
+
+    template <typename... Args>
+    T &emplace_back(Args &&...args)
+    {
+        if (count >= NodeMaxSize)
+        {
+            throw std::out_of_range("RingArray capacity exceeded");
+        }
+        T *slot_ptr = new (raw_ptr(count)) T(std::forward<Args>(args)...);
+        ++count;
+        return *slot_ptr;
+    }
+
+    void push_front(const T &value)
+    {
+        emplace_front(value);
+    }
+
+    void push_front(T &&value)
+    {
+        emplace_front(std::move(value));
+    }
+
+    template <typename... Args>
+    T &emplace_front(Args &&...args)
+    {
+        if (count >= NodeMaxSize)
+        {
+            throw std::out_of_range("RingArray capacity exceeded");
+        }
+        size_t new_first = first == 0 ? NodeMaxSize - 1 : first - 1;
+        T *slot_ptr = new (&elements[new_first * sizeof(T)]) T(std::forward<Args>(args)...);
+        first = new_first;
+        ++count;
+        return *slot_ptr;
+    }
+
+    void insert(size_t index, const T &value)
+    {
+        emplace(index, value);
+    }
+
+    template <typename InputIt>
+    void insert(size_t index, InputIt first, InputIt last)
+    {
+        size_t n = static_cast<size_t>(std::distance(first, last));
+        if (n > NodeMaxSize - count)
+        {
+            throw std::out_of_range("RingArray capacity exceeded");
+        }
+        if (index > count)
+        {
+            throw std::out_of_range("Index out of range");
+        }
+        if (n == 0)
+        {
+            return;
+        }
+        bool shift_front = index < count - index;
+        if (shift_front)
+        {
+            first_slot_back(n);
+            for (size_t i = 0; i < index; ++i)
+            {
+                relocate(i + n, i);
+            }
+        }
+        else
+        {
+            for (size_t i = count; i > index; --i)
+            {
+                relocate(i - 1, i - 1 + n);
+            }
+        }
+        size_t built = 0;
+        try
+        {
+            for (; built < n; ++built, ++first)
+            {
+                new (raw_ptr(index + built)) T(*first);
+            }
+        }
+        catch (...)
+        {
+            for (size_t i = 0; i < built; ++i)
+            {
+                element_ptr(index + i)->~T();
+            }
+            if (shift_front)
+            {
+                for (size_t i = index; i > 0; --i)
+                {
+                    relocate(i - 1, i - 1 + n);
+                }
+                first_slot_forward(n);
+            }
+            else
+            {
+                for (size_t i = index; i < count; ++i)
+                {
+                    relocate(i + n, i);
+                }
+            }
+            throw;
+        }
+        count += n;
+    }
+
+    void insert(size_t index, T &&value)
+    {
+        emplace(index, std::move(value));
+    }
+
+    template <typename... Args>
+    T &emplace(size_t index, Args &&...args)
+    {
+        if (count >= NodeMaxSize)
+        {
+            throw std::out_of_range("RingArray capacity exceeded");
+        }
+        if (index > count)
+        {
+            throw std::out_of_range("Index out of range");
+        }
+        if (index == count)
+        {
+            return emplace_back(std::forward<Args>(args)...);
+        }
+        if (index == 0)
+        {
+            return emplace_front(std::forward<Args>(args)...);
+        }
+        T value(std::forward<Args>(args)...);
+        if (index < count - index)
+        {
+            first = first == 0 ? NodeMaxSize - 1 : first - 1;
+            for (size_t i = 0; i < index; ++i)
+            {
+                relocate(i + 1, i);
+            }
+        }
+        else
+        {
+            for (size_t i = count; i > index; --i)
+            {
+                relocate(i - 1, i);
+            }
+        }
+        T *slot_ptr = new (raw_ptr(index)) T(std::move(value));
+        ++count;
+        return *slot_ptr;
+    }
+
+    void erase(size_t index)
+    {
+        if (index >= count)
+        {
+            throw std::out_of_range("Index out of range");
+        }
+        element_ptr(index)->~T();
+        if (index < count - 1 - index)
+        {
+            for (size_t i = index; i > 0; --i)
+            {
+                relocate(i - 1, i);
+            }
+            first = first + 1 == NodeMaxSize ? 0 : first + 1;
+        }
+        else
+        {
+            for (size_t i = index; i + 1 < count; ++i)
+            {
+                relocate(i + 1, i);
+            }
+        }
+        --count;
+    }
+
+    void erase(size_t from, size_t to)
+    {
+        if (from > to || to > count)
+        {
+            throw std::out_of_range("Index out of range");
+        }
+        size_t n = to - from;
+        if (n == 0)
+        {
+            return;
+        }
+        for (size_t i = from; i < to; ++i)
+        {
+            element_ptr(i)->~T();
+        }
+        if (from < count - to)
+        {
+            for (size_t i = from; i > 0; --i)
+            {
+                relocate(i - 1, i - 1 + n);
+            }
+            first_slot_forward(n);
+        }
+        else
+        {
+            for (size_t i = to; i < count; ++i)
+            {
+                relocate(i, i - n);
+            }
+        }
+        count -= n;
+    }
+
+    T &operator[](size_t index) noexcept { return *element_ptr(index); }
+    const T &operator[](size_t index) const noexcept { return *element_ptr(index); }
+
+    static constexpr bool contiguous = false;
+
+    // Calls f(pointer, length) for each contiguous run, at most twice when
+    // the elements wrap around the end of the buffer.
+    template <typename F>
+    void for_each_segment(F &&f)
+    {
+        size_t head_run = NodeMaxSize - first < count ? NodeMaxSize - first : count;
+        if (head_run)
+            f(element_ptr(0), head_run);
+        if (count > head_run)
+            f(element_ptr(head_run), count - head_run);
+    }
+
+    template <typename F>
+    void for_each_segment(F &&f) const
+    {
+        size_t head_run = NodeMaxSize - first < count ? NodeMaxSize - first : count;
+        if (head_run)
+            f(element_ptr(0), head_run);
+        if (count > head_run)
+            f(element_ptr(head_run), count - head_run);
+    }
+
+    T &front()
+    {
+        if (count == 0)
+        {
+            throw std::out_of_range("RingArray is empty");
+        }
+        return *element_ptr(0);
+    }
+
+    const T &front() const
+    {
+        if (count == 0)
+        {
+            throw std::out_of_range("RingArray is empty");
+        }
+        return *element_ptr(0);
+    }
+
+    T &back()
+    {
+        if (count == 0)
+        {
+            throw std::out_of_range("RingArray is empty");
+        }
+        return *element_ptr(count - 1);
+    }
+
+    const T &back() const
+    {
+        if (count == 0)
+        {
+            throw std::out_of_range("RingArray is empty");
+        }
+        return *element_ptr(count - 1);
+    }
+
+    void pop_back()
+    {
+        if (count == 0)
+        {
+            throw std::out_of_range("RingArray is empty");
+        }
+        element_ptr(count - 1)->~T();
+        --count;
+    }
+
+    void pop_front()
+    {
+        if (count == 0)
+        {
+            throw std::out_of_range("RingArray is empty");
+        }
+        element_ptr(0)->~T();
+        first = first + 1 == NodeMaxSize ? 0 : first + 1;
+        --count;
+    }
+
+    void clear() noexcept
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            element_ptr(i)->~T();
+        }
+        first = 0;
+        count = 0;
+    }
+
+    size_t size() const noexcept { return count; }
+    size_t capacity() const noexcept { return NodeMaxSize; }
+    bool empty() const noexcept { return count == 0; }
+    bool full() const noexcept { return count == NodeMaxSize; }
+
+    iterator begin() noexcept { return iterator(this, 0); }
+    iterator end() noexcept { return iterator(this, count); }
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    const_iterator end() const noexcept { return const_iterator(this, count); }
+    const_iterator cbegin() const noexcept { return const_iterator(this, 0); }
+    const_iterator cend() const noexcept { return const_iterator(this, count); }
+};
+
+#endif
@@ -0,0 +1,296 @@
+#ifndef SIMD_SCAN_H
+#define SIMD_SCAN_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define SIMD_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+// Scans over one contiguous run of elements. int32_t, float and double get
+// SSE2/AVX2 kernels picked once at runtime; every other type (and non-x86
+// builds) goes through the standard algorithms.
+
+enum class simd_isa
+{
+    scalar,
+    sse2,
+    avx2
+};
+
+inline simd_isa detected_simd_isa() noexcept
+{
+#ifdef SIMD_SCAN_X86
+    static const simd_isa isa = __builtin_cpu_supports("avx2") ? simd_isa::avx2 : simd_isa::sse2;
+    return isa;
+#else
+    return simd_isa::scalar;
+#endif
+}
+
+template <typename T>
+struct simd_kernel_table
+{
+    std::size_t (*find)(const T *, std::size_t, T) noexcept;
+    std::size_t (*count)(const T *, std::size_t, T) noexcept;
+    std::size_t (*min_index)(const T *, std::size_t) noexcept;
+    std::size_t (*max_index)(const T *, std::size_t) noexcept;
+    T (*sum)(const T *, std::size_t) noexcept;
+};
+
+#ifdef SIMD_SCAN_X86
+
+#define SIMD_SCAN_SSE2 __attribute__((target("sse2")))
+#define SIMD_SCAN_AVX2 __attribute__((target("avx2")))
+
+// Lane operations per instruction set and element type. eq() and
+// unordered() return one bit per lane.
+struct sse2_i32
+{
+    using value_type = std::int32_t;
+    using vec = __m128i;
+    static constexpr std::size_t lanes = 4;
+
+    SIMD_SCAN_SSE2 static vec load(const value_type *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+    SIMD_SCAN_SSE2 static void store(value_type *p, vec v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+    SIMD_SCAN_SSE2 static vec broadcast(value_type v) { return _mm_set1_epi32(v); }
+    SIMD_SCAN_SSE2 static unsigned eq(vec a, vec b) { return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b))); }
+    SIMD_SCAN_SSE2 static unsigned unordered(vec) { return 0; }
+    SIMD_SCAN_SSE2 static vec add(vec a, vec b) { return _mm_add_epi32(a, b); }
+
+    SIMD_SCAN_SSE2 static vec min(vec a, vec b)
+    {
+        vec lt = _mm_cmplt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(lt, a), _mm_andnot_si128(lt, b));
+    }
+
+    SIMD_SCAN_SSE2 static vec max(vec a, vec b)
+    {
+        vec gt = _mm_cmpgt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+    }
+};
+
+struct sse2_f32
+{
+    using value_type = float;
+    using vec = __m128;
+    static constexpr std::size_t lanes = 4;
+
+    SIMD_SCAN_SSE2 static vec load(const value_type *p) { return _mm_loadu_ps(p); }
+    SIMD_SCAN_SSE2 static void store(value_type *p, vec v) { _mm_storeu_ps(p, v); }
+    SIMD_SCAN_SSE2 static vec broadcast(value_type v) { return _mm_set1_ps(v); }
+    SIMD_SCAN_SSE2 static unsigned eq(vec a, vec b) { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)); }
+    SIMD_SCAN_SSE2 static unsigned unordered(vec a) { return _mm_movemask_ps(_mm_cmpunord_ps(a, a)); }
+    SIMD_SCAN_SSE2 static vec add(vec a, vec b) { return _mm_add_ps(a, b); }
+    SIMD_SCAN_SSE2 static vec min(vec a, vec b) { return _mm_min_ps(a, b); }
+    SIMD_SCAN_SSE2 static vec max(vec a, vec b) { return _mm_max_ps(a, b); }
+};
+
+struct sse2_f64
+{
+    using value_type = double;
+    using vec = __m128d;
+    static constexpr std::size_t lanes = 2;
+
+    SIMD_SCAN_SSE2 static vec load(const value_type *p) { return _mm_loadu_pd(p); }
+    SIMD_SCAN_SSE2 static void store(value_type *p, vec v) { _mm_storeu_pd(p, v); }
+    SIMD_SCAN_SSE2 static vec broadcast(value_type v) { return _mm_set1_pd(v); }
+    SIMD_SCAN_SSE2 static unsigned eq(vec a, vec b) { return _mm_movemask_pd(_mm_cmpeq_pd(a, b)); }
+    SIMD_SCAN_SSE2 static unsigned unordered(vec a) { return _mm_movemask_pd(_mm_cmpunord_pd(a, a)); }
+    SIMD_SCAN_SSE2 static vec add(vec a, vec b) { return _mm_add_pd(a, b); }
+    SIMD_SCAN_SSE2 static vec min(vec a, vec b) { return _mm_min_pd(a, b); }
+    SIMD_SCAN_SSE2 static vec max(vec a, vec b) { return _mm_max_pd(a, b); }
+};
+
+struct avx2_i32
+{
+    using value_type = std::int32_t;
+    using vec = __m256i;
+    static constexpr std::size_t lanes = 8;
+
+    SIMD_SCAN_AVX2 static vec load(const value_type *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+    SIMD_SCAN_AVX2 static void store(value_type *p, vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+    SIMD_SCAN_AVX2 static vec broadcast(value_type v) { return _mm256_set1_epi32(v); }
+    SIMD_SCAN_AVX2 static unsigned eq(vec a, vec b) { return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b))); }
+    SIMD_SCAN_AVX2 static unsigned unordered(vec) { return 0; }
+    SIMD_SCAN_AVX2 static vec add(vec a, vec b) { return _mm256_add_epi32(a, b); }
+    SIMD_SCAN_AVX2 static vec min(vec a, vec b) { return _mm256_min_epi32(a, b); }
+    SIMD_SCAN_AVX2 static vec max(vec a, vec b) { return _mm256_max_epi32(a, b); }
+};
+
+struct avx2_f32
+{
+    using value_type = float;
+    using vec = __m256;
+    static constexpr std::size_t lanes = 8;
+
+    SIMD_SCAN_AVX2 static vec load(const value_type *p) { return _mm256_loadu_ps(p); }
+    SIMD_SCAN_AVX2 static void store(value_type *p, vec v) { _mm256_storeu_ps(p, v); }
+    SIMD_SCAN_AVX2 static vec broadcast(value_type v) { return _mm256_set1_ps(v); }
+    SIMD_SCAN_AVX2 static unsigned eq(vec a, vec b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)); }
+    SIMD_SCAN_AVX2 static unsigned unordered(vec a) { return _mm256_movemask_ps(_mm256_cmp_ps(a, a, _CMP_UNORD_Q)); }
+    SIMD_SCAN_AVX2 static vec add(vec a, vec b) { return _mm256_add_ps(a, b); }
+    SIMD_SCAN_AVX2 static vec min(vec a, vec b) { return _mm256_min_ps(a, b); }
+    SIMD_SCAN_AVX2 static vec max(vec a, vec b) { return _mm256_max_ps(a, b); }
+};
+
+struct avx2_f64
+{
+    using value_type = double;
+    using vec = __m256d;
+    static constexpr std::size_t lanes = 4;
+
+    SIMD_SCAN_AVX2 static vec load(const value_type *p) { return _mm256_loadu_pd(p); }
+    SIMD_SCAN_AVX2 static void store(value_type *p, vec v) { _mm256_storeu_pd(p, v); }
+    SIMD_SCAN_AVX2 static vec broadcast(value_type v) { return _mm256_set1_pd(v); }
+    SIMD_SCAN_AVX2 static unsigned eq(vec a, vec b) { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)); }
+    SIMD_SCAN_AVX2 static unsigned unordered(vec a) { return _mm256_movemask_pd(_mm256_cmp_pd(a, a, _CMP_UNORD_Q)); }
+    SIMD_SCAN_AVX2 static vec add(vec a, vec b) { return _mm256_add_pd(a, b); }
+    SIMD_SCAN_AVX2 static vec min(vec a, vec b) { return _mm256_min_pd(a, b); }
+    SIMD_SCAN_AVX2 static vec max(vec a, vec b) { return _mm256_max_pd(a, b); }
+};
+
+// The kernels are stamped out once per instruction set so that every
+// function inlining the lane operations carries the matching target.
+#define SIMD_SCAN_KERNELS simd_sse2_kernels
+#define SIMD_SCAN_TARGET SIMD_SCAN_SSE2
+#include "simd_scan_kernels.inc"
+#undef SIMD_SCAN_KERNELS
+#undef SIMD_SCAN_TARGET
+
+#define SIMD_SCAN_KERNELS simd_avx2_kernels
+#define SIMD_SCAN_TARGET SIMD_SCAN_AVX2
+#include "simd_scan_kernels.inc"
+#undef SIMD_SCAN_KERNELS
+#undef SIMD_SCAN_TARGET
+
+template <typename T>
+struct simd_ops
+{
+};
+
+template <>
+struct simd_ops<std::int32_t>
+{
+    using sse2 = sse2_i32;
+    using avx2 = avx2_i32;
+};
+
+template <>
+struct simd_ops<float>
+{
+    using sse2 = sse2_f32;
+    using avx2 = avx2_f32;
+};
+
+template <>
+struct simd_ops<double>
+{
+    using sse2 = sse2_f64;
+    using avx2 = avx2_f64;
+};
+
+template <typename T>
+inline constexpr bool simd_scan_supported = std::is_same_v<T, std::int32_t> || std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+// Shorter runs do not amortize the indirect call and lane reductions.
+constexpr std::size_t simd_scan_min_run = 32;
+
+template <typename T, typename Kernels>
+constexpr simd_kernel_table<T> make_simd_kernel_table() noexcept
+{
+    return {Kernels::find, Kernels::count, Kernels::min_index, Kernels::max_index, Kernels::sum};
+}
+
+template <typename T>
+const simd_kernel_table<T> &simd_kernels() noexcept
+{
+    static const simd_kernel_table<T> sse2 = make_simd_kernel_table<T, simd_sse2_kernels<typename simd_ops<T>::sse2>>();
+    static const simd_kernel_table<T> avx2 = make_simd_kernel_table<T, simd_avx2_kernels<typename simd_ops<T>::avx2>>();
+    return detected_simd_isa() == simd_isa::avx2 ? avx2 : sse2;
+}
+
+#else
+
+template <typename T>
+inline constexpr bool simd_scan_supported = false;
+
+constexpr std::size_t simd_scan_min_run = 0;
+
+#endif
+
+template <typename T>
+std::size_t simd_find(const T *data, std::size_t n, const T &value)
+{
+#ifdef SIMD_SCAN_X86
+    if constexpr (simd_scan_supported<T>)
+    {
+        if (n >= simd_scan_min_run)
+            return simd_kernels<T>().find(data, n, value);
+    }
+#endif
+    return static_cast<std::size_t>(std::find(data, data + n, value) - data);
+}
+
+template <typename T>
+std::size_t simd_count(const T *data, std::size_t n, const T &value)
+{
+#ifdef SIMD_SCAN_X86
+    if constexpr (simd_scan_supported<T>)
+    {
+        if (n >= simd_scan_min_run)
+            return simd_kernels<T>().count(data, n, value);
+    }
+#endif
+    return static_cast<std::size_t>(std::count(data, data + n, value));
+}
+
+// Index of the first smallest element, as std::min_element; n when empty.
+template <typename T>
+std::size_t simd_min_index(const T *data, std::size_t n)
+{
+#ifdef SIMD_SCAN_X86
+    if constexpr (simd_scan_supported<T>)
+    {
+        if (n >= simd_scan_min_run)
+            return simd_kernels<T>().min_index(data, n);
+    }
+#endif
+    return static_cast<std::size_t>(std::min_element(data, data + n) - data);
+}
+
+template <typename T>
+std::size_t simd_max_index(const T *data, std::size_t n)
+{
+#ifdef SIMD_SCAN_X86
+    if constexpr (simd_scan_supported<T>)
+    {
+        if (n >= simd_scan_min_run)
+            return simd_kernels<T>().max_index(data, n);
+    }
+#endif
+    return static_cast<std::size_t>(std::max_element(data, data + n) - data);
+}
+
+// init + the run. The vector kernels add lane-wise, so floating-point sums
+// are reassociated the way std::reduce would.
+template <typename T>
+T simd_accumulate(const T *data, std::size_t n, T init)
+{
+#ifdef SIMD_SCAN_X86
+    if constexpr (simd_scan_supported<T>)
+    {
+        if (n >= simd_scan_min_run)
+            return init + simd_kernels<T>().sum(data, n);
+    }
+#endif
+    return std::accumulate(data, data + n, init);
+}
+
+#endif
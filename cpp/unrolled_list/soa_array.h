@@ -0,0 +1,523 @@
+#ifndef SOA_ARRAY_H
+#define SOA_ARRAY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Field list of an aggregate, e.g. soa_fields<&particle::x, &particle::y>.
+template <auto... Members>
+struct soa_fields
+{
+};
+
+// Specialize for T with `using fields = soa_fields<...>;` naming the data
+// members SoaArray stores. Members left out come back value-initialized.
+template <typename T>
+struct soa_traits;
+
+template <typename M>
+struct soa_member;
+
+template <typename C, typename F>
+struct soa_member<F C::*>
+{
+    using type = F;
+};
+
+template <auto Member>
+using soa_field_t = typename soa_member<decltype(Member)>::type;
+
+template <typename T, size_t NodeMaxSize, typename Fields = typename soa_traits<T>::fields>
+class SoaArray;
+
+// Node storage that keeps one array per field instead of whole T objects,
+// so a scan over one field reads only that field's bytes. Elements are
+// gathered into a T on read and scattered on write; references are proxies.
+template <typename T, size_t NodeMaxSize, auto... Members>
+class SoaArray<T, NodeMaxSize, soa_fields<Members...>>
+{
+    static_assert(sizeof...(Members) > 0, "soa_traits must list at least one field");
+    static_assert(std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>,
+                  "SoaArray stores trivially copyable, default constructible aggregates");
+
+private:
+    static constexpr size_t field_count = sizeof...(Members);
+    static constexpr size_t field_sizes[] = {sizeof(soa_field_t<Members>)...};
+    static constexpr size_t field_aligns[] = {alignof(soa_field_t<Members>)...};
+
+    template <size_t I>
+    using field_type = std::tuple_element_t<I, std::tuple<soa_field_t<Members>...>>;
+
+    template <size_t I>
+    static constexpr auto member = std::get<I>(std::make_tuple(Members...));
+
+    static constexpr size_t column_offset(size_t field) noexcept
+    {
+        size_t offset = 0;
+        for (size_t i = 0;; ++i)
+        {
+            offset = (offset + field_aligns[i] - 1) / field_aligns[i] * field_aligns[i];
+            if (i == field)
+                return offset;
+            offset += field_sizes[i] * NodeMaxSize;
+        }
+    }
+
+    static constexpr size_t column_bytes = column_offset(field_count - 1) + field_sizes[field_count - 1] * NodeMaxSize;
+
+    size_t count;
+    alignas(std::max({alignof(soa_field_t<Members>)...})) std::byte columns[column_bytes];
+
+    template <size_t I>
+    field_type<I> *column_at() noexcept
+    {
+        return reinterpret_cast<field_type<I> *>(&columns[column_offset(I)]);
+    }
+
+    template <size_t I>
+    const field_type<I> *column_at() const noexcept
+    {
+        return reinterpret_cast<const field_type<I> *>(&columns[column_offset(I)]);
+    }
+
+    template <typename F, size_t... Is>
+    static void visit_fields(F &f, std::index_sequence<Is...>)
+    {
+        (f(std::integral_constant<size_t, Is>()), ...);
+    }
+
+    template <typename F>
+    static void for_each_field(F &&f)
+    {
+        visit_fields(f, std::make_index_sequence<field_count>());
+    }
+
+    template <auto A, auto B>
+    static constexpr bool same_member() noexcept
+    {
+        if constexpr (std::is_same_v<decltype(A), decltype(B)>)
+            return A == B;
+        else
+            return false;
+    }
+
+    template <auto Member>
+    static constexpr size_t field_index() noexcept
+    {
+        size_t index = 0;
+        size_t found = field_count;
+        ((found = found == field_count && same_member<Member, Members>() ? index : found, ++index), ...);
+        return found;
+    }
+
+    void store(size_t index, const T &value) noexcept
+    {
+        for_each_field([&](auto field) {
+            constexpr size_t I = decltype(field)::value;
+            std::memcpy(column_at<I>() + index, &(value.*member<I>), sizeof(field_type<I>));
+        });
+    }
+
+    T load(size_t index) const noexcept
+    {
+        T value{};
+        for_each_field([&](auto field) {
+            constexpr size_t I = decltype(field)::value;
+            std::memcpy(&(value.*member<I>), column_at<I>() + index, sizeof(field_type<I>));
+        });
+        return value;
+    }
+
+    static constexpr size_t segment_block = NodeMaxSize < 64 ? NodeMaxSize : 64;
+
+    void gather(size_t first, size_t n, T *out) const noexcept
+    {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = load(first + i);
+    }
+
+    // Moves the n elements starting at `from` to start at `to`, column by
+    // column.
+    void relocate_range(size_t from, size_t to, size_t n) noexcept
+    {
+        if (from == to || n == 0)
+            return;
+        for_each_field([&](auto field) {
+            constexpr size_t I = decltype(field)::value;
+            std::memmove(column_at<I>() + to, column_at<I>() + from, n * sizeof(field_type<I>));
+        });
+    }
+
+    template <typename... Args>
+    static T make(Args &&...args)
+    {
+        if constexpr (std::is_constructible_v<T, Args &&...>)
+            return T(std::forward<Args>(args)...);
+        else
+            return T{std::forward<Args>(args)...};
+    }
+
+public:
+    // Stands in for T & : reads gather the fields, writes scatter them.
+    class reference
+    {
+    public:
+        reference(SoaArray *array, size_t index) noexcept : array_(array), ind_(index) {}
+        reference(const reference &) = default;
+
+        operator T() const noexcept { return array_->load(ind_); }
+
+        reference &operator=(const T &value) noexcept
+        {
+            array_->store(ind_, value);
+            return *this;
+        }
+
+        reference &operator=(const reference &other) noexcept { return *this = static_cast<T>(other); }
+
+        template <auto Member>
+        soa_field_t<Member> &get() const noexcept
+        {
+            return array_->template column<Member>()[ind_];
+        }
+
+        friend void swap(reference a, reference b) noexcept
+        {
+            T tmp = a;
+            a = static_cast<T>(b);
+            b = tmp;
+        }
+
+    private:
+        SoaArray *array_;
+        size_t ind_;
+    };
+
+    using value_type = T;
+    using const_reference = T;
+    using pointer = void;
+    using const_pointer = void;
+
+    template <typename Array, typename Ref>
+    class basic_iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Ref;
+
+        basic_iterator(Array *array, size_t index) : array_(array), ind_(index) {}
+
+        template <typename OtherArray, typename OtherRef,
+                  typename = std::enable_if_t<std::is_convertible_v<OtherArray *, Array *>>>
+        basic_iterator(const basic_iterator<OtherArray, OtherRef> &other) : array_(other.array_), ind_(other.ind_)
+        {
+        }
+
+        reference operator*() const { return (*array_)[ind_]; }
+        reference operator[](difference_type n) const { return (*array_)[ind_ + n]; }
+
+        basic_iterator &operator++()
+        {
+            ++ind_;
+            return *this;
+        }
+        basic_iterator operator++(int)
+        {
+            basic_iterator tmp = *this;
+            ++ind_;
+            return tmp;
+        }
+        basic_iterator &operator--()
+        {
+            --ind_;
+            return *this;
+        }
+        basic_iterator operator--(int)
+        {
+            basic_iterator tmp = *this;
+            --ind_;
+            return tmp;
+        }
+
+        bool operator==(const basic_iterator &other) const { return array_ == other.array_ && ind_ == other.ind_; }
+        bool operator!=(const basic_iterator &other) const { return !(*this == other); }
+        bool operator<(const basic_iterator &other) const { return ind_ < other.ind_; }
+        bool operator>(const basic_iterator &other) const { return ind_ > other.ind_; }
+        bool operator<=(const basic_iterator &other) const { return ind_ <= other.ind_; }
+        bool operator>=(const basic_iterator &other) const { return ind_ >= other.ind_; }
+        difference_type operator-(const basic_iterator &other) const
+        {
+            return static_cast<difference_type>(ind_) - static_cast<difference_type>(other.ind_);
+        }
+
+        basic_iterator &operator+=(difference_type n)
+        {
+            ind_ += n;
+            return *this;
+        }
+        basic_iterator &operator-=(difference_type n)
+        {
+            ind_ -= n;
+            return *this;
+        }
+        basic_iterator operator+(difference_type n) const { return basic_iterator(array_, ind_ + n); }
+        basic_iterator operator-(difference_type n) const { return basic_iterator(array_, ind_ - n); }
+        friend basic_iterator operator+(difference_type n, const basic_iterator &it) { return it + n; }
+
+    private:
+        template <typename, typename>
+        friend class basic_iterator;
+        Array *array_;
+        size_t ind_;
+    };
+
+    using iterator = basic_iterator<SoaArray, reference>;
+    using const_iterator = basic_iterator<const SoaArray, const_reference>;
+
+    SoaArray() : count(0)
+    {
+        static_assert(NodeMaxSize > 0, "SoaArray capacity must be greater than 0");
+    }
+
+    SoaArray(const SoaArray &other) : count(other.count)
+    {
+        for_each_field([&](auto field) {
+            constexpr size_t I = decltype(field)::value;
+            std::memcpy(column_at<I>(), other.column_at<I>(), count * sizeof(field_type<I>));
+        });
+    }
+
+    SoaArray &operator=(const SoaArray &other)
+    {
+        if (this != &other)
+        {
+            count = other.count;
+            for_each_field([&](auto field) {
+                constexpr size_t I = decltype(field)::value;
+                std::memcpy(column_at<I>(), other.column_at<I>(), count * sizeof(field_type<I>));
+            });
+        }
+        return *this;
+    }
+
+    // The column holding Member for every element, valid for [0, size()).
+    template <auto Member>
+    soa_field_t<Member> *column() noexcept
+    {
+        constexpr size_t I = field_index<Member>();
+        static_assert(I < field_count, "member is not in the soa_traits field list");
+        return column_at<I>();
+    }
+
+    template <auto Member>
+    const soa_field_t<Member> *column() const noexcept
+    {
+        constexpr size_t I = field_index<Member>();
+        static_assert(I < field_count, "member is not in the soa_traits field list");
+        return column_at<I>();
+    }
+
+    void push_back(const T &value) { emplace_back(value); }
+
+    template <typename... Args>
+    reference emplace_back(Args &&...args)
+    {
+        if (count >= NodeMaxSize)
+        {
+            throw std::out_of_range("SoaArray capacity exceeded");
+        }
+        store(count, make(std::forward<Args>(args)...));
+        return reference(this, count++);
+    }
+
+    void push_front(const T &value) { emplace(0, value); }
+
+    template <typename... Args>
+    reference emplace_front(Args &&...args)
+    {
+        return emplace(0, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    reference emplace(size_t index, Args &&...args)
+    {
+        if (count >= NodeMaxSize)
+        {
+            throw std::out_of_range("SoaArray capacity exceeded");
+        }
+        if (index > count)
+        {
+            throw std::out_of_range("Index out of range");
+        }
+        T value = make(std::forward<Args>(args)...);
+        relocate_range(index, index + 1, count - index);
+        store(index, value);
+        ++count;
+        return reference(this, index);
+    }
+
+    void insert(size_t index, const T &value) { emplace(index, value); }
+
+    template <typename InputIt>
+    void insert(size_t index, InputIt first, InputIt last)
+    {
+        size_t n = static_cast<size_t>(std::distance(first, last));
+        if (n > NodeMaxSize - count)
+        {
+            throw std::out_of_range("SoaArray capacity exceeded");
+        }
+        if (index > count)
+        {
+            throw std::out_of_range("Index out of range");
+        }
+        relocate_range(index, index + n, count - index);
+        try
+        {
+            for (size_t i = 0; i < n; ++i, ++first)
+            {
+                store(index + i, static_cast<T>(*first));
+            }
+        }
+        catch (...)
+        {
+            relocate_range(index + n, index, count - index);
+            throw;
+        }
+        count += n;
+    }
+
+    void erase(size_t index)
+    {
+        if (index >= count)
+        {
+            throw std::out_of_range("Index out of range");
+        }
+        relocate_range(index + 1, index, count - index - 1);
+        --count;
+    }
+
+    void erase(size_t first, size_t last)
+    {
+        if (first > last || last > count)
+        {
+            throw std::out_of_range("Index out of range");
+        }
+        relocate_range(last, first, count - last);
+        count -= last - first;
+    }
+
+    reference operator[](size_t index) noexcept { return reference(this, index); }
+    const_reference operator[](size_t index) const noexcept { return load(index); }
+
+    static constexpr bool contiguous = false;
+
+    // Calls f(pointer, length) over copies of the elements, gathered up to
+    // segment_block at a time into a buffer on the stack, so the generic
+    // whole-element scans work on this storage too. The non-const overload
+    // scatters each block back once f returns. Scans over one field are
+    // cheaper through column().
+    template <typename F>
+    void for_each_segment(F &&f)
+    {
+        T buffer[segment_block];
+        for (size_t first = 0; first < count; first += segment_block)
+        {
+            size_t n = std::min(segment_block, count - first);
+            gather(first, n, buffer);
+            f(static_cast<T *>(buffer), n);
+            for (size_t i = 0; i < n; ++i)
+                store(first + i, buffer[i]);
+        }
+    }
+
+    template <typename F>
+    void for_each_segment(F &&f) const
+    {
+        T buffer[segment_block];
+        for (size_t first = 0; first < count; first += segment_block)
+        {
+            size_t n = std::min(segment_block, count - first);
+            gather(first, n, buffer);
+            f(static_cast<const T *>(buffer), n);
+        }
+    }
+
+    reference front()
+    {
+        if (count == 0)
+        {
+            throw std::out_of_range("SoaArray is empty");
+        }
+        return reference(this, 0);
+    }
+
+    const_reference front() const
+    {
+        if (count == 0)
+        {
+            throw std::out_of_range("SoaArray is empty");
+        }
+        return load(0);
+    }
+
+    reference back()
+    {
+        if (count == 0)
+        {
+            throw std::out_of_range("SoaArray is empty");
+        }
+        return reference(this, count - 1);
+    }
+
+    const_reference back() const
+    {
+        if (count == 0)
+        {
+            throw std::out_of_range("SoaArray is empty");
+        }
+        return load(count - 1);
+    }
+
+    void pop_back()
+    {
+        if (count == 0)
+        {
+            throw std::out_of_range("SoaArray is empty");
+        }
+        --count;
+    }
+
+    void pop_front()
+    {
+        if (count == 0)
+        {
+            throw std::out_of_range("SoaArray is empty");
+        }
+        erase(0);
+    }
+
+    void clear() noexcept { count = 0; }
+
+    size_t size() const noexcept { return count; }
+    size_t capacity() const noexcept { return NodeMaxSize; }
+    bool empty() const noexcept { return count == 0; }
+    bool full() const noexcept { return count == NodeMaxSize; }
+
+    iterator begin() noexcept { return iterator(this, 0); }
+    iterator end() noexcept { return iterator(this, count); }
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    const_iterator end() const noexcept { return const_iterator(this, count); }
+    const_iterator cbegin() const noexcept { return const_iterator(this, 0); }
+    const_iterator cend() const noexcept { return const_iterator(this, count); }
+};
+
+#endif
@@ -0,0 +1,333 @@
+#ifndef SORTED_UNROLLED_LIST_H
+#define SORTED_UNROLLED_LIST_H
+
+#include "unrolled_list.h"
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Ordered set of unique keys kept in an unrolled_list. Next to the list sits
+// a sorted vector holding the first key of every node, so a lookup is a
+// binary search over node first keys followed by one inside a single node,
+// the leaf level of a B+ tree. Iteration walks the node chain like any
+// unrolled_list.
+template <typename Key, std::size_t NodeMaxSize = 64, typename Compare = std::less<Key>,
+          typename Alloc = std::allocator<Key>, typename Policy = unrolled_list_policy>
+class sorted_unrolled_list
+{
+    friend struct unrolled_list_test_access;
+
+private:
+    using list_type = unrolled_list<Key, NodeMaxSize, Alloc, Policy>;
+    using Node = typename list_type::Node;
+
+    struct index_entry
+    {
+        Key first;
+        Node *node;
+    };
+
+    using IndexAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<index_entry>;
+
+    list_type list;
+    std::vector<index_entry, IndexAlloc> index;
+    Compare comp;
+
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using key_compare = Compare;
+    using allocator_type = Alloc;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = const Key &;
+    using const_reference = const Key &;
+    using iterator = typename list_type::const_iterator;
+    using const_iterator = typename list_type::const_iterator;
+
+    sorted_unrolled_list() : sorted_unrolled_list(Compare()) {}
+
+    explicit sorted_unrolled_list(const Compare &comp, const Alloc &alloc = Alloc())
+        : list(alloc), index(IndexAlloc(alloc)), comp(comp)
+    {
+    }
+
+    template <typename InputIt, typename = typename list_type::template RequireInputIterator<InputIt>>
+    sorted_unrolled_list(InputIt first, InputIt last, const Compare &comp = Compare(), const Alloc &alloc = Alloc())
+        : sorted_unrolled_list(comp, alloc)
+    {
+        for (; first != last; ++first)
+        {
+            insert(*first);
+        }
+    }
+
+    sorted_unrolled_list(std::initializer_list<Key> init, const Compare &comp = Compare(), const Alloc &alloc = Alloc())
+        : sorted_unrolled_list(init.begin(), init.end(), comp, alloc)
+    {
+    }
+
+    sorted_unrolled_list(const sorted_unrolled_list &other)
+        : list(other.list), index(IndexAlloc(list.get_allocator())), comp(other.comp)
+    {
+        rebuild_index();
+    }
+
+    sorted_unrolled_list(sorted_unrolled_list &&other) noexcept(std::is_nothrow_move_constructible_v<Compare>)
+        : list(std::move(other.list)), index(std::move(other.index)), comp(std::move(other.comp))
+    {
+        other.index.clear();
+        retarget_inline_node(other);
+    }
+
+    sorted_unrolled_list &operator=(const sorted_unrolled_list &other)
+    {
+        if (this != &other)
+        {
+            list = other.list;
+            comp = other.comp;
+            rebuild_index();
+        }
+        return *this;
+    }
+
+    sorted_unrolled_list &operator=(sorted_unrolled_list &&other)
+    {
+        if (this != &other)
+        {
+            // With equal allocators the nodes change hands, and so can the
+            // index that points at them.
+            bool steals = std::allocator_traits<Alloc>::propagate_on_container_move_assignment::value ||
+                          list.get_allocator() == other.list.get_allocator();
+            list = std::move(other.list);
+            comp = std::move(other.comp);
+            if (steals)
+            {
+                index = std::move(other.index);
+                retarget_inline_node(other);
+            }
+            else
+            {
+                rebuild_index();
+            }
+            other.clear();
+        }
+        return *this;
+    }
+
+    const_iterator begin() const noexcept { return list.cbegin(); }
+    const_iterator end() const noexcept { return list.cend(); }
+    const_iterator cbegin() const noexcept { return list.cbegin(); }
+    const_iterator cend() const noexcept { return list.cend(); }
+
+    size_type size() const noexcept { return list.size(); }
+    bool empty() const noexcept { return list.empty(); }
+    key_compare key_comp() const { return comp; }
+    allocator_type get_allocator() const noexcept { return list.get_allocator(); }
+
+    // Node count and the per-node arrays, e.g. for for_each_segment scans.
+    size_type node_count() const noexcept { return index.size(); }
+    const list_type &elements() const noexcept { return list; }
+
+    void clear() noexcept
+    {
+        list.clear();
+        index.clear();
+    }
+
+    std::pair<iterator, bool> insert(const Key &key) { return emplace_key(key); }
+
+    std::pair<iterator, bool> insert(Key &&key) { return emplace_key(std::move(key)); }
+
+    template <typename InputIt, typename = typename list_type::template RequireInputIterator<InputIt>>
+    void insert(InputIt first, InputIt last)
+    {
+        for (; first != last; ++first)
+        {
+            insert(*first);
+        }
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        size_t entry = find_entry(*pos);
+        iterator next = list.erase(pos);
+        refresh_index(entry);
+        return next;
+    }
+
+    size_type erase(const Key &key)
+    {
+        const_iterator pos = find(key);
+        if (pos == end())
+            return 0;
+        size_t entry = find_entry(key);
+        list.erase(pos);
+        refresh_index(entry);
+        return 1;
+    }
+
+    const_iterator find(const Key &key) const
+    {
+        const_iterator pos = lower_bound(key);
+        return pos != end() && !comp(key, *pos) ? pos : end();
+    }
+
+    bool contains(const Key &key) const { return find(key) != end(); }
+
+    size_type count(const Key &key) const { return contains(key) ? 1 : 0; }
+
+    const_iterator lower_bound(const Key &key) const
+    {
+        if (index.empty())
+            return end();
+        Node *node = index[find_entry(key)].node;
+        return make_iterator(node, node_lower_bound(node, key));
+    }
+
+    const_iterator upper_bound(const Key &key) const
+    {
+        if (index.empty())
+            return end();
+        Node *node = index[find_entry(key)].node;
+        size_t lo = 0;
+        size_t hi = node->elements.size();
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            if (comp(key, node->elements[mid]))
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        return make_iterator(node, lo);
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(const Key &key) const
+    {
+        return {lower_bound(key), upper_bound(key)};
+    }
+
+    void swap(sorted_unrolled_list &other) noexcept
+    {
+        list.swap(other.list);
+        index.swap(other.index);
+        std::swap(comp, other.comp);
+        retarget_inline_node(other);
+        other.retarget_inline_node(*this);
+    }
+
+    bool operator==(const sorted_unrolled_list &other) const { return list == other.list; }
+    bool operator!=(const sorted_unrolled_list &other) const { return !(*this == other); }
+
+private:
+    // The last node whose first key is not greater than key, or the first
+    // node when key sorts before everything.
+    size_t find_entry(const Key &key) const
+    {
+        auto it = std::upper_bound(index.begin(), index.end(), key,
+                                   [this](const Key &k, const index_entry &e) { return comp(k, e.first); });
+        return it == index.begin() ? 0 : static_cast<size_t>(it - index.begin()) - 1;
+    }
+
+    size_t node_lower_bound(const Node *node, const Key &key) const
+    {
+        size_t lo = 0;
+        size_t hi = node->elements.size();
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            if (comp(node->elements[mid], key))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    const_iterator make_iterator(Node *node, size_t pos) const noexcept
+    {
+        if (pos == node->elements.size())
+        {
+            node = node->next;
+            pos = 0;
+        }
+        return node ? const_iterator(node, pos, &list) : end();
+    }
+
+    template <typename K>
+    std::pair<iterator, bool> emplace_key(K &&key)
+    {
+        if (index.empty())
+        {
+            list.push_back(std::forward<K>(key));
+            rebuild_index();
+            return {begin(), true};
+        }
+        size_t entry = find_entry(key);
+        Node *node = index[entry].node;
+        size_t pos = node_lower_bound(node, key);
+        if (pos < node->elements.size() && !comp(key, node->elements[pos]))
+            return {const_iterator(node, pos, &list), false};
+
+        iterator result = list.emplace(const_iterator(node, pos), std::forward<K>(key));
+        refresh_index(entry);
+        return {result, true};
+    }
+
+    // Entries around `entry` are rebuilt from the node chain after an insert
+    // split that node or an erase rebalanced it with a neighbour.
+    void refresh_index(size_t entry)
+    {
+        size_t lo = entry > 0 ? entry - 1 : 0;
+        size_t hi = std::min(entry + 2, index.size());
+        Node *stop = hi < index.size() ? index[hi].node : nullptr;
+        Node *node = lo > 0 ? index[lo - 1].node->next : list.head;
+
+        std::vector<index_entry, IndexAlloc> window(IndexAlloc(list.get_allocator()));
+        for (; node != stop; node = node->next)
+        {
+            if (!node->elements.empty())
+                window.push_back(index_entry{node->elements.front(), node});
+        }
+        auto first = index.begin() + static_cast<std::ptrdiff_t>(lo);
+        auto last = index.begin() + static_cast<std::ptrdiff_t>(hi);
+        size_t common = std::min(window.size(), hi - lo);
+        std::move(window.begin(), window.begin() + static_cast<std::ptrdiff_t>(common), first);
+        if (window.size() > common)
+            index.insert(last, std::make_move_iterator(window.begin() + static_cast<std::ptrdiff_t>(common)),
+                         std::make_move_iterator(window.end()));
+        else
+            index.erase(first + static_cast<std::ptrdiff_t>(common), last);
+    }
+
+    // Moving or swapping the list relocates an inline node into the
+    // receiving list's own slot; point its index entry there.
+    void retarget_inline_node(const sorted_unrolled_list &other) noexcept
+    {
+        if constexpr (Policy::inline_node)
+        {
+            for (index_entry &entry : index)
+            {
+                if (other.list.inline_slot.holds(entry.node))
+                    entry.node = list.inline_slot.get();
+            }
+        }
+    }
+
+    void rebuild_index()
+    {
+        index.clear();
+        for (Node *node = list.size() ? list.head : nullptr; node; node = node->next)
+        {
+            if (!node->elements.empty())
+                index.push_back(index_entry{node->elements.front(), node});
+        }
+    }
+};
+
+#endif
@@ -5,13 +5,16 @@
 #include <stdexcept>
 #include <new>
 #include <memory>
+#include <utility>
+#include <cstring>
+#include <type_traits>
 
 template <typename T, size_t NodeMaxSize>
 class StaticArray
 {
 private:
-    alignas(alignof(T)) std::byte elements[NodeMaxSize * sizeof(T)];
     size_t count;
+    alignas(alignof(T)) std::byte elements[NodeMaxSize * sizeof(T)];
 
     T *element_ptr(size_t index) noexcept
     {
@@ -23,11 +26,64 @@ private:
         return std::launder(reinterpret_cast<const T *>(&elements[index * sizeof(T)]));
     }
 
+    static constexpr bool trivially_relocatable = std::is_trivially_copyable_v<T>;
+
+    // Copies other's elements into this empty array in one pass.
+    void copy_from(const StaticArray &other)
+    {
+        if constexpr (trivially_relocatable)
+            std::memcpy(elements, other.elements, other.count * sizeof(T));
+        else
+            std::uninitialized_copy(other.element_ptr(0), other.element_ptr(0) + other.count, reinterpret_cast<T *>(elements));
+        count = other.count;
+    }
+
+    // Moves the n elements starting at `from` to start at `to`; the vacated
+    // slots are left uninitialized.
+    void relocate_range(size_t from, size_t to, size_t n) noexcept(trivially_relocatable || std::is_nothrow_move_constructible_v<T>)
+    {
+        if (from == to || n == 0)
+        {
+            return;
+        }
+        if constexpr (trivially_relocatable)
+        {
+            std::memmove(&elements[to * sizeof(T)], &elements[from * sizeof(T)], n * sizeof(T));
+        }
+        else if (to < from)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                new (&elements[(to + i) * sizeof(T)]) T(std::move(*element_ptr(from + i)));
+                element_ptr(from + i)->~T();
+            }
+        }
+        else
+        {
+            for (size_t i = n; i > 0; --i)
+            {
+                new (&elements[(to + i - 1) * sizeof(T)]) T(std::move(*element_ptr(from + i - 1)));
+                element_ptr(from + i - 1)->~T();
+            }
+        }
+    }
+
+    void relocate_tail(size_t from, size_t to) noexcept(trivially_relocatable || std::is_nothrow_move_constructible_v<T>)
+    {
+        relocate_range(from, to, count - from);
+    }
+
 public:
+    using value_type = T;
+    using reference = T &;
+    using const_reference = const T &;
+    using pointer = T *;
+    using const_pointer = const T *;
+
     class iterator
     {
     public:
-        using iterator_category = std::bidirectional_iterator_tag;
+        using iterator_category = std::random_access_iterator_tag;
         using value_type = T;
         using difference_type = std::ptrdiff_t;
         using pointer = T *;
@@ -63,8 +119,27 @@ public:
 
         bool operator==(const iterator &other) const { return array_ == other.array_ && ind_ == other.ind_; }
         bool operator!=(const iterator &other) const { return !(*this == other); }
+        bool operator<(const iterator &other) const { return ind_ < other.ind_; }
+        bool operator>(const iterator &other) const { return ind_ > other.ind_; }
+        bool operator<=(const iterator &other) const { return ind_ <= other.ind_; }
+        bool operator>=(const iterator &other) const { return ind_ >= other.ind_; }
         difference_type operator-(const iterator &other) const { return ind_ - other.ind_; }
 
+        iterator &operator+=(difference_type n)
+        {
+            ind_ += n;
+            return *this;
+        }
+        iterator &operator-=(difference_type n)
+        {
+            ind_ -= n;
+            return *this;
+        }
+        iterator operator+(difference_type n) const { return iterator(array_, ind_ + n); }
+        iterator operator-(difference_type n) const { return iterator(array_, ind_ - n); }
+        friend iterator operator+(difference_type n, const iterator &it) { return it + n; }
+        reference operator[](difference_type n) const { return *array_->element_ptr(ind_ + n); }
+
     private:
         StaticArray *array_;
         size_t ind_;
@@ -74,7 +149,7 @@ public:
     class const_iterator
     {
     public:
-        using iterator_category = std::bidirectional_iterator_tag;
+        using iterator_category = std::random_access_iterator_tag;
         using value_type = T;
         using difference_type = std::ptrdiff_t;
         using pointer = const T *;
@@ -111,8 +186,27 @@ public:
 
         bool operator==(const const_iterator &other) const { return array_ == other.array_ && ind_ == other.ind_; }
         bool operator!=(const const_iterator &other) const { return !(*this == other); }
+        bool operator<(const const_iterator &other) const { return ind_ < other.ind_; }
+        bool operator>(const const_iterator &other) const { return ind_ > other.ind_; }
+        bool operator<=(const const_iterator &other) const { return ind_ <= other.ind_; }
+        bool operator>=(const const_iterator &other) const { return ind_ >= other.ind_; }
         difference_type operator-(const const_iterator &other) const { return ind_ - other.ind_; }
 
+        const_iterator &operator+=(difference_type n)
+        {
+            ind_ += n;
+            return *this;
+        }
+        const_iterator &operator-=(difference_type n)
+        {
+            ind_ -= n;
+            return *this;
+        }
+        const_iterator operator+(difference_type n) const { return const_iterator(array_, ind_ + n); }
+        const_iterator operator-(difference_type n) const { return const_iterator(array_, ind_ - n); }
+        friend const_iterator operator+(difference_type n, const const_iterator &it) { return it + n; }
+        reference operator[](difference_type n) const { return *array_->element_ptr(ind_ + n); }
+
     private:
         const StaticArray *array_;
         size_t ind_;
@@ -124,19 +218,62 @@ public:
         static_assert(NodeMaxSize > 0, "StaticArray capacity must be greater than 0");
     }
 
+    StaticArray(const StaticArray &other) : count(0)
+    {
+        copy_from(other);
+    }
+
+    StaticArray &operator=(const StaticArray &other)
+    {
+        if (this != &other)
+        {
+            clear();
+            copy_from(other);
+        }
+        return *this;
+    }
+
     ~StaticArray()
     {
         clear();
     }
 
     void push_back(const T &value)
+    {
+        emplace_back(value);
+    }
+
+    void push_back(T &&value)
+    {
+        emplace_back(std::move(value));
+    }
+
+    template <typename... Args>
+    T &emplace_back(Args &&...args)
     {
         if (count >= NodeMaxSize)
         {
             throw std::out_of_range("StaticArray capacity exceeded");
         }
-        new (element_ptr(count)) T(value);
+        T *slot = new (element_ptr(count)) T(std::forward<Args>(args)...);
         ++count;
+        return *slot;
+    }
+
+    void push_front(const T &value)
+    {
+        emplace(0, value);
+    }
+
+    void push_front(T &&value)
+    {
+        emplace(0, std::move(value));
+    }
+
+    template <typename... Args>
+    T &emplace_front(Args &&...args)
+    {
+        return emplace(0, std::forward<Args>(args)...);
     }
 
     void erase(size_t index)
@@ -146,15 +283,61 @@ public:
             throw std::out_of_range("Index out of range");
         }
         element_ptr(index)->~T();
-        for (size_t i = index; i < count - 1; ++i)
+        relocate_tail(index + 1, index);
+        --count;
+    }
+
+    void erase(size_t first, size_t last)
+    {
+        if (first > last || last > count)
         {
-            new (element_ptr(i)) T(*element_ptr(i + 1));
-            element_ptr(i + 1)->~T();
+            throw std::out_of_range("Index out of range");
         }
-        --count;
+        for (size_t i = first; i < last; ++i)
+        {
+            element_ptr(i)->~T();
+        }
+        relocate_tail(last, first);
+        count -= last - first;
     }
 
     void insert(size_t index, const T &value)
+    {
+        emplace(index, value);
+    }
+
+    template <typename InputIt>
+    void insert(size_t index, InputIt first, InputIt last)
+    {
+        size_t n = static_cast<size_t>(std::distance(first, last));
+        if (n > NodeMaxSize - count)
+        {
+            throw std::out_of_range("StaticArray capacity exceeded");
+        }
+        if (index > count)
+        {
+            throw std::out_of_range("Index out of range");
+        }
+        relocate_tail(index, index + n);
+        try
+        {
+            std::uninitialized_copy_n(first, n, reinterpret_cast<T *>(&elements[index * sizeof(T)]));
+        }
+        catch (...)
+        {
+            relocate_range(index + n, index, count - index);
+            throw;
+        }
+        count += n;
+    }
+
+    void insert(size_t index, T &&value)
+    {
+        emplace(index, std::move(value));
+    }
+
+    template <typename... Args>
+    T &emplace(size_t index, Args &&...args)
     {
         if (count >= NodeMaxSize)
         {
@@ -164,13 +347,35 @@ public:
         {
             throw std::out_of_range("Index out of range");
         }
-        for (size_t i = count; i > index; --i)
+        if (index == count)
         {
-            new (element_ptr(i)) T(*element_ptr(i - 1));
-            element_ptr(i - 1)->~T();
+            return emplace_back(std::forward<Args>(args)...);
         }
-        new (element_ptr(index)) T(value);
+        T value(std::forward<Args>(args)...);
+        relocate_tail(index, index + 1);
+        T *slot = new (&elements[index * sizeof(T)]) T(std::move(value));
         ++count;
+        return *slot;
+    }
+
+    T &operator[](size_t index) noexcept { return *element_ptr(index); }
+    const T &operator[](size_t index) const noexcept { return *element_ptr(index); }
+
+    static constexpr bool contiguous = true;
+
+    T *data() noexcept { return element_ptr(0); }
+    const T *data() const noexcept { return element_ptr(0); }
+
+    template <typename F>
+    void for_each_segment(F &&f)
+    {
+        f(data(), count);
+    }
+
+    template <typename F>
+    void for_each_segment(F &&f) const
+    {
+        f(data(), count);
     }
 
     T &front()
@@ -219,6 +424,15 @@ public:
         --count;
     }
 
+    void pop_front()
+    {
+        if (count == 0)
+        {
+            throw std::out_of_range("StaticArray is empty");
+        }
+        erase(0);
+    }
+
     void clear() noexcept
     {
         for (size_t i = 0; i < count; ++i)
@@ -0,0 +1,990 @@
+#include "../concurrent_unrolled_list.h"
+#include "../mapped_unrolled_list.h"
+#include "../parallel_algorithms.h"
+#include "../persistent_unrolled_list.h"
+#include "../sorted_unrolled_list.h"
+#include "../unrolled_list.h"
+#include "../unrolled_queue.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                                   \
+    do                                                                                \
+    {                                                                                 \
+        if (!(cond))                                                                  \
+        {                                                                             \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                               \
+        }                                                                             \
+    } while (0)
+
+struct unrolled_list_test_access
+{
+    template <typename List>
+    static std::vector<std::size_t> node_sizes(const List &list)
+    {
+        std::vector<std::size_t> sizes;
+        for (auto *node = list.size() ? list.head : nullptr; node; node = node->next)
+            sizes.push_back(node->elements.size());
+        return sizes;
+    }
+
+    // Links agree in both directions, no node is empty or over capacity,
+    // every node but the first and last holds at least min_fill elements,
+    // and the node sizes add up to size().
+    template <typename List>
+    static bool valid(const List &list)
+    {
+        if (!list.size())
+            return true;
+        if (list.head->prev || list.tail->next)
+            return false;
+        std::size_t total = 0;
+        for (auto *node = list.head; node; node = node->next)
+        {
+            std::size_t size = node->elements.size();
+            if (size == 0 || size > List::node_capacity || (node->next && node->next->prev != node))
+                return false;
+            if (node != list.head && node != list.tail && size < List::min_fill)
+                return false;
+            if (!node->next && node != list.tail)
+                return false;
+            total += size;
+        }
+        return total == list.size();
+    }
+
+    // The node list is valid and its index holds each node and first key.
+    template <typename Key, std::size_t N, typename Compare, typename Alloc, typename Policy>
+    static bool index_valid(const sorted_unrolled_list<Key, N, Compare, Alloc, Policy> &set)
+    {
+        if (!valid(set.list))
+            return false;
+        std::size_t entry = 0;
+        for (auto *node = set.list.size() ? set.list.head : nullptr; node; node = node->next, ++entry)
+        {
+            if (entry == set.index.size() || set.index[entry].node != node ||
+                set.index[entry].first != node->elements.front())
+                return false;
+        }
+        return entry == set.index.size();
+    }
+
+    // Every block an spsc queue has allocated, recycled ones included.
+    template <typename T, std::size_t N>
+    static std::size_t block_count(const spsc_unrolled_queue<T, N> &queue)
+    {
+        std::size_t count = 1;
+        for (auto *block = queue.oldest; block != queue.tail; block = block->next.load())
+            ++count;
+        return count;
+    }
+
+    // Element offset of a small list's inline node, or -1 when the inline
+    // node is not in use.
+    template <typename List>
+    static long inline_node_offset(const List &list)
+    {
+        long offset = 0;
+        for (auto *node = list.size() ? list.head : nullptr; node; node = node->next)
+        {
+            if (list.inline_slot.holds(node))
+                return offset;
+            offset += static_cast<long>(node->elements.size());
+        }
+        return -1;
+    }
+};
+
+template <typename List>
+std::string layout(const List &list)
+{
+    std::string result;
+    for (std::size_t size : unrolled_list_test_access::node_sizes(list))
+        result += (result.empty() ? "" : " ") + std::to_string(size);
+    return result;
+}
+
+template <typename List, typename T>
+bool holds(const List &list, const std::vector<T> &expected)
+{
+    return list.size() == expected.size() && std::equal(list.begin(), list.end(), expected.begin());
+}
+
+using half_list = unrolled_list<int, 6, std::allocator<int>, half_full_policy>;
+
+void insert_range_before_underfull_head()
+{
+    half_list list;
+    std::vector<int> expected;
+    for (int i = 0; i < 12; ++i)
+    {
+        list.push_back(i);
+        expected.push_back(i);
+    }
+    list.push_front(-1);
+    expected.insert(expected.begin(), -1);
+    CHECK(layout(list) == "1 6 6");
+
+    std::vector<int> chunk = {100, 101, 102, 103, 104, 105, 106};
+    auto it = list.insert(list.cbegin(), chunk.begin(), chunk.end());
+    expected.insert(expected.begin(), chunk.begin(), chunk.end());
+    CHECK(unrolled_list_test_access::valid(list));
+    CHECK(holds(list, expected));
+    CHECK(*it == 100);
+
+    list.insert(list.cbegin(), 6, 7);
+    expected.insert(expected.begin(), 6, 7);
+    CHECK(unrolled_list_test_access::valid(list));
+    CHECK(holds(list, expected));
+}
+
+void splice_before_underfull_head()
+{
+    half_list list;
+    half_list other;
+    std::vector<int> expected;
+    for (int i = 0; i < 12; ++i)
+    {
+        list.push_back(i);
+        expected.push_back(i);
+    }
+    list.push_front(-1);
+    expected.insert(expected.begin(), -1);
+    std::vector<int> moved;
+    for (int i = 0; i < 7; ++i)
+    {
+        other.push_back(100 + i);
+        moved.push_back(100 + i);
+    }
+    CHECK(layout(other) == "6 1");
+
+    list.splice(list.cbegin(), other);
+    expected.insert(expected.begin(), moved.begin(), moved.end());
+    CHECK(other.empty());
+    CHECK(unrolled_list_test_access::valid(list));
+    CHECK(holds(list, expected));
+
+    half_list rest = list.split_at(list.iterator_at(5));
+    CHECK(unrolled_list_test_access::valid(list));
+    CHECK(unrolled_list_test_access::valid(rest));
+    CHECK(holds(list, std::vector<int>(expected.begin(), expected.begin() + 5)));
+    CHECK(holds(rest, std::vector<int>(expected.begin() + 5, expected.end())));
+}
+
+template <typename List>
+void step_back_from_end()
+{
+    List list;
+    CHECK(list.end() - 0 == list.end());
+    for (int i = 0; i < 25; ++i)
+        list.push_back(i);
+
+    CHECK(list.end() - 1 == std::prev(list.end()));
+    CHECK(*(list.end() - 1) == 24);
+    CHECK(*std::prev(list.cend()) == 24);
+    CHECK(*(list.cend() - 25) == 0);
+    CHECK(list.end() - 25 == list.begin());
+
+    auto it = list.end();
+    it -= 7;
+    CHECK(*it == 18);
+    CHECK(std::distance(it, list.end()) == 7);
+
+    typename List::const_iterator cit = list.end();
+    --cit;
+    CHECK(*cit == 24);
+    CHECK(*list.rbegin() == 24);
+}
+
+// Rewrites the header of a saved file, then expects both readers to
+// reject it.
+template <typename Edit>
+bool rejects(const char *path, const std::vector<std::byte> &bytes, Edit edit)
+{
+    unrolled_list_file_header header;
+    std::vector<std::byte> copy = bytes;
+    std::memcpy(&header, copy.data(), sizeof(header));
+    edit(header);
+    std::memcpy(copy.data(), &header, sizeof(header));
+    std::FILE *file = std::fopen(path, "wb");
+    std::fwrite(copy.data(), 1, copy.size(), file);
+    std::fclose(file);
+
+    int thrown = 0;
+    try
+    {
+        mapped_unrolled_list<int> mapped(path);
+    }
+    catch (const std::runtime_error &)
+    {
+        ++thrown;
+    }
+    try
+    {
+        unrolled_list<int, 8> list;
+        list.load(path);
+    }
+    catch (const std::runtime_error &)
+    {
+        ++thrown;
+    }
+    return thrown == 2;
+}
+
+void reject_damaged_files()
+{
+    const char *path = "unrolled_list_test.bin";
+    unrolled_list<int, 8> list;
+    for (int i = 0; i < 100; ++i)
+        list.push_back(i);
+    list.save(path);
+    {
+        mapped_unrolled_list<int> mapped(path);
+        CHECK(mapped.size() == 100);
+        CHECK(std::equal(mapped.begin(), mapped.end(), list.begin()));
+    }
+
+    std::vector<std::byte> bytes;
+    std::FILE *file = std::fopen(path, "rb");
+    for (int c; (c = std::fgetc(file)) != EOF;)
+        bytes.push_back(static_cast<std::byte>(c));
+    std::fclose(file);
+
+    CHECK(rejects(path, bytes, [](unrolled_list_file_header &h) { h.size += 1; }));
+    CHECK(rejects(path, bytes, [](unrolled_list_file_header &h) { h.size -= 1; }));
+    CHECK(rejects(path, bytes, [](unrolled_list_file_header &h) { h.block_count = std::uint64_t(1) << 62; }));
+    CHECK(rejects(path, bytes, [](unrolled_list_file_header &h) { h.block_capacity = ~std::uint64_t(0) / 2; }));
+    CHECK(rejects(path, bytes, [](unrolled_list_file_header &h) {
+        h.block_capacity = (std::uint64_t(1) << 62) + 2;
+        h.block_count = 4;
+    }));
+
+    // A header with no blocks is an empty list whatever its block capacity;
+    // neither reader may size anything by that capacity.
+    unrolled_list_file_header empty;
+    std::memcpy(&empty, bytes.data(), sizeof(empty));
+    empty.block_capacity = std::uint64_t(1) << 42;
+    empty.block_count = 0;
+    empty.size = 0;
+    std::vector<std::byte> header_only(empty.data_offset());
+    std::memcpy(header_only.data(), &empty, sizeof(empty));
+    CHECK(rejects(path, header_only, [](unrolled_list_file_header &h) { h.size = 1; }));
+    CHECK(rejects(path, header_only, [](unrolled_list_file_header &h) { h.block_count = 1; }));
+    CHECK(!rejects(path, header_only, [](unrolled_list_file_header &) {}));
+    try
+    {
+        list.load(path);
+        CHECK(list.empty());
+        CHECK(mapped_unrolled_list<int>(path).size() == 0);
+    }
+    catch (const std::exception &)
+    {
+        CHECK(false);
+    }
+    std::remove(path);
+}
+
+// The inline node of a small list can sit in the middle of the chain,
+// where a piece of parallel_sort may start.
+void parallel_sort_small_list()
+{
+    using small_list = unrolled_list<int, 8, std::allocator<int>, small_list_policy<>>;
+    thread_pool pool(4);
+    int inline_starts_piece = 0;
+    for (std::size_t at = 8; at < 200; at += 3)
+    {
+        small_list list;
+        std::vector<int> expected;
+        for (int i = 0; i < 200; ++i)
+        {
+            list.push_back((i * 7919) % 200);
+            expected.push_back((i * 7919) % 200);
+        }
+        // Freeing the head node frees the inline slot; the next node split
+        // takes it somewhere in the middle.
+        list.erase(list.begin(), list.iterator_at(8));
+        expected.erase(expected.begin(), expected.begin() + 8);
+        while (unrolled_list_test_access::inline_node_offset(list) < 0)
+        {
+            list.insert(list.iterator_at(at - 8), -1);
+            expected.insert(expected.begin() + static_cast<std::ptrdiff_t>(at - 8), -1);
+        }
+        long inline_offset = unrolled_list_test_access::inline_node_offset(list);
+        CHECK(inline_offset > 0);
+        long offset = 0;
+        for (const auto &chunk : partition_segments(list, pool.size()))
+        {
+            inline_starts_piece += offset == inline_offset;
+            auto it = chunk.first;
+            for (std::size_t i = 0; i < chunk.segments; ++i, ++it)
+                offset += static_cast<long>((*it).size());
+        }
+
+        parallel_sort(pool, list);
+        std::sort(expected.begin(), expected.end());
+        CHECK(unrolled_list_test_access::valid(list));
+        CHECK(holds(list, expected));
+    }
+    CHECK(inline_starts_piece > 0);
+}
+
+// A comparator that throws leaves every node in the list; one that throws
+// straight away leaves the order untouched.
+void sort_keeps_nodes_on_throw()
+{
+    thread_pool pool(4);
+    std::vector<int> values;
+    for (int i = 0; i < 1000; ++i)
+        values.push_back((i * 7919) % 1000);
+    for (bool parallel : {false, true})
+    {
+        for (long limit : {0L, 500L, 5000L})
+        {
+            unrolled_list<int, 16> list(values.begin(), values.end());
+            std::atomic<long> calls{0};
+            auto comp = [&](int a, int b) {
+                if (calls.fetch_add(1) >= limit)
+                    throw std::runtime_error("compare");
+                return a < b;
+            };
+            bool thrown = false;
+            try
+            {
+                if (parallel)
+                    parallel_sort(pool, list, comp);
+                else
+                    list.sort(comp);
+            }
+            catch (const std::runtime_error &)
+            {
+                thrown = true;
+            }
+            CHECK(thrown);
+            CHECK(list.size() == values.size());
+            CHECK(unrolled_list_test_access::valid(list));
+            if (limit == 0)
+                CHECK(holds(list, values));
+        }
+    }
+}
+
+struct point
+{
+    int x;
+    int y;
+};
+
+// Free functions so SoaArray's proxy references convert on either side.
+bool operator==(const point &a, const point &b) { return a.x == b.x && a.y == b.y; }
+bool operator!=(const point &a, const point &b) { return !(a == b); }
+bool operator<(const point &a, const point &b) { return a.x < b.x || (a.x == b.x && a.y < b.y); }
+
+template <>
+struct soa_traits<point>
+{
+    using fields = soa_fields<&point::x, &point::y>;
+};
+
+// Whole-element scans over column-wise nodes go through gathered copies;
+// writes through for_each_segment land back in the columns.
+void soa_segment_scans()
+{
+    unrolled_list<point, 100, std::allocator<point>, soa_policy<>> list;
+    for (int i = 0; i < 1000; ++i)
+        list.push_back(point{(i * 37) % 1000, i});
+
+    CHECK(list.find(point{370, 10}) == list.iterator_at(10));
+    CHECK(list.find(point{370, 11}) == list.end());
+    CHECK(list.count(point{0, 0}) == 1);
+    CHECK(list.min_element() == list.iterator_at(0));
+    CHECK(list.max_element() == list.iterator_at(27));
+
+    list.for_each_segment([](auto seg) {
+        for (point &p : seg)
+            p.y = -p.y;
+    });
+    long long sum = 0;
+    list.for_each_field_segment<&point::y>([&](auto seg) {
+        for (int y : seg)
+            sum += y;
+    });
+    CHECK(sum == -999LL * 1000 / 2);
+}
+
+struct half_ring_policy : half_full_policy
+{
+    template <typename T, std::size_t NodeMaxSize>
+    using storage = RingArray<T, NodeMaxSize>;
+};
+
+struct half_indexed_policy : half_full_policy
+{
+    static constexpr bool indexed = true;
+};
+
+template <typename T>
+T make(int v)
+{
+    if constexpr (std::is_same_v<T, point>)
+        return point{v, -v};
+    else
+        return static_cast<T>(v);
+}
+
+// Runs random inserts, erases, splices, splits and merges against a list
+// and a std::vector side by side, checking node fill and contents after
+// every step.
+template <typename List>
+void random_operations(const char *name)
+{
+    using T = typename List::value_type;
+    std::mt19937 rng(12345);
+    auto below = [&](std::size_t n) { return n ? static_cast<std::size_t>(rng() % n) : 0; };
+    auto values = [&](std::size_t n) {
+        std::vector<T> result;
+        for (std::size_t i = 0; i < n; ++i)
+            result.push_back(make<T>(static_cast<int>(rng() % 1000)));
+        return result;
+    };
+
+    List list;
+    std::vector<T> expected;
+    for (int step = 0; step < 3000; ++step)
+    {
+        int op = static_cast<int>(rng() % 13);
+        std::size_t size = expected.size();
+        std::size_t pos = below(size + 1);
+        std::size_t end = pos + below(size - pos + 1);
+        switch (op)
+        {
+        case 0:
+        {
+            T v = make<T>(step);
+            list.push_back(v);
+            expected.push_back(v);
+            break;
+        }
+        case 1:
+        {
+            T v = make<T>(step);
+            list.push_front(v);
+            expected.insert(expected.begin(), v);
+            break;
+        }
+        case 2:
+        {
+            T v = make<T>(step);
+            list.insert(pos, v);
+            expected.insert(expected.begin() + pos, v);
+            break;
+        }
+        case 3:
+        {
+            std::vector<T> chunk = values(below(40));
+            list.insert(list.iterator_at(pos), chunk.begin(), chunk.end());
+            expected.insert(expected.begin() + pos, chunk.begin(), chunk.end());
+            break;
+        }
+        case 4:
+        {
+            std::size_t n = below(20);
+            T v = make<T>(step);
+            list.insert(list.iterator_at(pos), n, v);
+            expected.insert(expected.begin() + pos, n, v);
+            break;
+        }
+        case 5:
+            if (pos < size)
+            {
+                list.erase(pos);
+                expected.erase(expected.begin() + pos);
+            }
+            break;
+        case 6:
+            list.erase(list.iterator_at(pos), list.iterator_at(end));
+            expected.erase(expected.begin() + pos, expected.begin() + end);
+            break;
+        case 7:
+        {
+            std::vector<T> chunk = values(below(30));
+            List other(chunk.begin(), chunk.end());
+            std::size_t first = below(chunk.size() + 1);
+            std::size_t last = first + below(chunk.size() - first + 1);
+            list.splice(list.iterator_at(pos), other, other.iterator_at(first), other.iterator_at(last));
+            expected.insert(expected.begin() + pos, chunk.begin() + first, chunk.begin() + last);
+            chunk.erase(chunk.begin() + first, chunk.begin() + last);
+            if (!unrolled_list_test_access::valid(other) || !holds(other, chunk))
+            {
+                std::fprintf(stderr, "%s: step %d: splice source broken\n", name, step);
+                ++failures;
+                return;
+            }
+            break;
+        }
+        case 8:
+        {
+            // Moves [pos, end) to another position in the same list.
+            std::size_t to = below(size - (end - pos) + 1);
+            std::vector<T> moved(expected.begin() + pos, expected.begin() + end);
+            expected.erase(expected.begin() + pos, expected.begin() + end);
+            std::size_t target = to < pos ? to : to + (end - pos);
+            list.splice(list.iterator_at(target), list, list.iterator_at(pos), list.iterator_at(end));
+            expected.insert(expected.begin() + to, moved.begin(), moved.end());
+            break;
+        }
+        case 9:
+        {
+            List rest = list.split_at(list.iterator_at(pos));
+            std::vector<T> tail(expected.begin() + pos, expected.end());
+            expected.erase(expected.begin() + pos, expected.end());
+            if (!unrolled_list_test_access::valid(rest) || !holds(rest, tail) ||
+                !unrolled_list_test_access::valid(list) || !holds(list, expected))
+            {
+                std::fprintf(stderr, "%s: step %d: split_at broken\n", name, step);
+                ++failures;
+                return;
+            }
+            list.splice(list.cend(), rest);
+            expected.insert(expected.end(), tail.begin(), tail.end());
+            break;
+        }
+        case 10:
+        {
+            std::vector<T> chunk = values(below(60));
+            std::sort(chunk.begin(), chunk.end());
+            List other(chunk.begin(), chunk.end());
+            list.sort();
+            std::sort(expected.begin(), expected.end());
+            list.merge(other);
+            std::vector<T> merged;
+            std::merge(expected.begin(), expected.end(), chunk.begin(), chunk.end(), std::back_inserter(merged));
+            expected = merged;
+            break;
+        }
+        case 11:
+            if (size)
+            {
+                list.pop_back();
+                expected.pop_back();
+                list.pop_front();
+                expected.erase(expected.begin());
+            }
+            break;
+        case 12:
+            if (step % 5 == 0)
+                list.compact();
+            else
+            {
+                List copy;
+                copy = list;
+                list = std::move(copy);
+            }
+            break;
+        }
+        if (!unrolled_list_test_access::valid(list) || !holds(list, expected))
+        {
+            std::fprintf(stderr, "%s: step %d: operation %d broke the list\n", name, step, op);
+            ++failures;
+            return;
+        }
+    }
+}
+
+// A comparator whose move may throw must not make the move noexcept.
+struct throwing_move_less
+{
+    throwing_move_less() = default;
+    throwing_move_less(const throwing_move_less &) = default;
+    throwing_move_less(throwing_move_less &&) noexcept(false) {}
+    bool operator()(int a, int b) const { return a < b; }
+};
+static_assert(std::is_nothrow_move_constructible_v<sorted_unrolled_list<int>>);
+static_assert(!std::is_nothrow_move_constructible_v<sorted_unrolled_list<int, 8, throwing_move_less>>);
+
+// Random inserts, erases and bound lookups against a std::set, with the
+// set moved out and back now and then.
+template <typename Policy>
+void sorted_list_matches_set(const char *name)
+{
+    using sorted_list = sorted_unrolled_list<int, 8, std::less<int>, std::allocator<int>, Policy>;
+    std::mt19937 rng(777);
+    sorted_list list;
+    std::set<int> expected;
+    auto same = [&](typename sorted_list::const_iterator it, typename std::set<int>::const_iterator ref) {
+        return it == list.end() ? ref == expected.end() : ref != expected.end() && *it == *ref;
+    };
+    for (int step = 0; step < 5000; ++step)
+    {
+        int key = static_cast<int>(rng() % 600);
+        bool ok = true;
+        switch (rng() % 6)
+        {
+        case 0:
+        case 1:
+        {
+            auto [it, inserted] = list.insert(key);
+            ok = inserted == expected.insert(key).second && *it == key;
+            break;
+        }
+        case 2:
+            ok = list.erase(key) == expected.erase(key);
+            break;
+        case 3:
+        {
+            auto it = list.find(key);
+            auto ref = expected.find(key);
+            ok = same(it, ref);
+            if (ok && ref != expected.end())
+                ok = same(list.erase(it), expected.erase(ref));
+            break;
+        }
+        case 4:
+            ok = same(list.lower_bound(key), expected.lower_bound(key)) &&
+                 same(list.upper_bound(key), expected.upper_bound(key));
+            break;
+        case 5:
+            if (step % 10 == 5)
+            {
+                sorted_list moved(std::move(list));
+                ok = list.empty() && unrolled_list_test_access::index_valid(list);
+                list = std::move(moved);
+                ok = ok && moved.empty() && unrolled_list_test_access::index_valid(moved);
+            }
+            break;
+        }
+        if (!ok || list.size() != expected.size() || !unrolled_list_test_access::index_valid(list) ||
+            !std::equal(list.begin(), list.end(), expected.begin(), expected.end()))
+        {
+            std::fprintf(stderr, "%s: step %d: sorted list differs from std::set\n", name, step);
+            ++failures;
+            return;
+        }
+    }
+}
+
+// Writes to a version never show through its snapshots. The list grows
+// past one chunk of nodes and then shrinks again, so chunks split and
+// nodes and chunks merge while older versions share them.
+void persistent_snapshots_stay_unchanged()
+{
+    using persistent_list = persistent_unrolled_list<int, 4>;
+    std::mt19937 rng(4242);
+    persistent_list list;
+    std::vector<int> expected;
+    std::vector<std::pair<persistent_list, std::vector<int>>> snapshots;
+    bool unchanged = true;
+    auto check_snapshots = [&] {
+        for (const auto &[snapshot, contents] : snapshots)
+            unchanged &= snapshot.size() == contents.size() &&
+                         std::equal(snapshot.begin(), snapshot.end(), contents.begin(), contents.end());
+    };
+    for (int step = 0; step < 9000; ++step)
+    {
+        unsigned erase_percent = step < 6000 ? 30 : 70;
+        unsigned roll = static_cast<unsigned>(rng() % 100);
+        std::size_t pos = expected.empty() ? 0 : rng() % expected.size();
+        if (roll < erase_percent)
+        {
+            if (!expected.empty())
+            {
+                list.erase(pos);
+                expected.erase(expected.begin() + static_cast<std::ptrdiff_t>(pos));
+            }
+        }
+        else if (roll < erase_percent + 15 && !expected.empty())
+        {
+            list.set(pos, step);
+            expected[pos] = step;
+        }
+        else
+        {
+            pos = rng() % (expected.size() + 1);
+            list.insert(pos, step);
+            expected.insert(expected.begin() + static_cast<std::ptrdiff_t>(pos), step);
+        }
+
+        if (step % 50 == 0)
+            snapshots.emplace_back(list.snapshot(), expected);
+        if (step % 500 == 250)
+        {
+            // Writing to a copy of an old snapshot leaves the snapshot alone.
+            auto &[snapshot, contents] = snapshots[rng() % snapshots.size()];
+            persistent_list copy = snapshot;
+            copy.push_front(-1);
+            if (!contents.empty())
+                copy.erase(copy.size() - 1);
+            check_snapshots();
+        }
+    }
+    check_snapshots();
+    CHECK(unchanged);
+    CHECK(list.size() == expected.size());
+    CHECK(std::equal(list.begin(), list.end(), expected.begin(), expected.end()));
+}
+
+// Blocks the consumer has left behind go back to the producer, so a queue
+// that never holds more than a few blocks' worth stays that size.
+void spsc_queue_recycles_blocks()
+{
+    spsc_unrolled_queue<std::string, 4> queue;
+    int pushed = 0;
+    int popped = 0;
+    bool in_order = true;
+    for (int i = 0; i < 3; ++i)
+        queue.push("element number " + std::to_string(pushed++));
+    for (int round = 0; round < 1000; ++round)
+    {
+        for (int i = 0; i < 10; ++i)
+            queue.push("element number " + std::to_string(pushed++));
+        std::string value;
+        for (int i = 0; i < 10 && queue.try_pop(value); ++i)
+            in_order &= value == "element number " + std::to_string(popped++);
+    }
+    std::vector<std::string> rest;
+    queue.pop_bulk(std::back_inserter(rest), pushed);
+    for (const std::string &value : rest)
+        in_order &= value == "element number " + std::to_string(popped++);
+    CHECK(in_order);
+    CHECK(popped == pushed);
+    CHECK(queue.empty());
+    CHECK(unrolled_list_test_access::block_count(queue) <= 8);
+}
+
+// One producer and one consumer, each mixing single and bulk calls, over
+// blocks small enough that both cross block boundaries constantly.
+void spsc_queue_threads()
+{
+    constexpr int total = 200000;
+    spsc_unrolled_queue<int, 8> queue;
+    std::thread producer([&] {
+        std::vector<int> batch;
+        for (int i = 0; i < total;)
+        {
+            if (i % 3 == 0)
+            {
+                batch.clear();
+                for (int k = 0; k < 5 && i < total; ++k)
+                    batch.push_back(i++);
+                queue.push_bulk(batch.begin(), batch.end());
+            }
+            else
+                queue.push(i++);
+        }
+    });
+    bool in_order = true;
+    int expected = 0;
+    int out[7];
+    while (expected < total)
+    {
+        if (expected % 2)
+        {
+            std::size_t n = queue.pop_bulk(out, 7);
+            for (std::size_t k = 0; k < n; ++k)
+                in_order &= out[k] == expected++;
+        }
+        else if (int value; queue.try_pop(value))
+            in_order &= value == expected++;
+    }
+    producer.join();
+    CHECK(in_order);
+    CHECK(queue.empty());
+}
+
+// Four producers and four consumers, mixing single and bulk calls; every
+// element comes out exactly once.
+void mpmc_queue_threads()
+{
+    constexpr int threads = 4;
+    constexpr int per_producer = 50000;
+    constexpr int total = threads * per_producer;
+    mpmc_unrolled_queue<int, 8> queue;
+    std::vector<std::atomic<int>> seen(total);
+    std::atomic<int> popped{0};
+    std::atomic<bool> out_of_range{false};
+    std::vector<std::thread> workers;
+    for (int p = 0; p < threads; ++p)
+    {
+        workers.emplace_back([&, p] {
+            int first = p * per_producer;
+            for (int i = 0; i < per_producer;)
+            {
+                if (i % 4 == 0 && i + 6 <= per_producer)
+                {
+                    int batch[6];
+                    for (int &value : batch)
+                        value = first + i++;
+                    queue.push_bulk(batch, batch + 6);
+                }
+                else
+                    queue.push(first + i++);
+            }
+        });
+    }
+    for (int c = 0; c < threads; ++c)
+    {
+        workers.emplace_back([&, c] {
+            int out[5];
+            while (popped.load() < total)
+            {
+                std::size_t n = c % 2 ? queue.pop_bulk(out, 5) : queue.try_pop(out[0]);
+                for (std::size_t k = 0; k < n; ++k)
+                {
+                    if (out[k] < 0 || out[k] >= total)
+                        out_of_range = true;
+                    else
+                        seen[out[k]].fetch_add(1);
+                }
+                popped.fetch_add(static_cast<int>(n));
+            }
+        });
+    }
+    for (std::thread &worker : workers)
+        worker.join();
+    CHECK(!out_of_range);
+    CHECK(popped.load() == total);
+    CHECK(std::all_of(seen.begin(), seen.end(), [](const std::atomic<int> &n) { return n.load() == 1; }));
+    CHECK(queue.empty());
+}
+
+// Four writers push at both ends, insert in the middle and erase while two
+// readers scan. Two elements present throughout must be seen by every scan,
+// exactly once each.
+void concurrent_list_threads()
+{
+    constexpr int writers = 4;
+    constexpr int per_writer = 4000;
+    concurrent_unrolled_list<int, 8> list;
+    list.push_back(-1);
+    list.push_back(-2);
+    std::atomic<bool> done{false};
+    std::atomic<bool> reader_failed{false};
+    std::vector<std::thread> threads;
+    for (int r = 0; r < 2; ++r)
+    {
+        threads.emplace_back([&] {
+            while (!done.load())
+            {
+                int first = 0;
+                int second = 0;
+                list.for_each([&](int x) {
+                    first += x == -1;
+                    second += x == -2;
+                    if (x < -2 || x >= writers * per_writer)
+                        reader_failed = true;
+                });
+                if (first != 1 || second != 1 || !list.contains(-1))
+                    reader_failed = true;
+            }
+        });
+    }
+    std::vector<std::thread> writing;
+    for (int w = 0; w < writers; ++w)
+    {
+        writing.emplace_back([&, w] {
+            int base = w * per_writer;
+            for (int i = 0; i < per_writer; ++i)
+            {
+                int value = base + i;
+                if (i % 3 == 0)
+                    list.push_back(value);
+                else if (i % 3 == 1)
+                    list.push_front(value);
+                else
+                    list.insert_before([value](int x) { return x == value - 1; }, value);
+                // Erases the element pushed at i % 8 == 4 again.
+                if (i % 8 == 7)
+                    list.erase(base + i - 3);
+            }
+        });
+    }
+    for (std::thread &writer : writing)
+        writer.join();
+    done = true;
+    for (std::thread &reader : threads)
+        reader.join();
+
+    std::vector<int> expected{-2, -1};
+    for (int w = 0; w < writers; ++w)
+        for (int i = 0; i < per_writer; ++i)
+            if (i % 8 != 4)
+                expected.push_back(w * per_writer + i);
+    std::vector<int> contents;
+    list.for_each([&](int x) { contents.push_back(x); });
+    std::sort(contents.begin(), contents.end());
+    CHECK(!reader_failed);
+    CHECK(list.size() == expected.size());
+    CHECK(contents == expected);
+}
+
+// Concurrent inserts before the first greater element keep the list sorted.
+void concurrent_list_sorted_inserts()
+{
+    constexpr int threads = 4;
+    concurrent_unrolled_list<int, 8> list;
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; ++t)
+    {
+        writers.emplace_back([&, t] {
+            for (int i = 0; i < 2000; ++i)
+            {
+                int value = (i * 7919 + t * 2003) % 8000;
+                list.insert_before([value](int x) { return x >= value; }, value);
+            }
+        });
+    }
+    for (std::thread &writer : writers)
+        writer.join();
+    std::vector<int> contents;
+    list.for_each([&](int x) { contents.push_back(x); });
+    CHECK(list.size() == threads * 2000);
+    CHECK(contents.size() == list.size());
+    CHECK(std::is_sorted(contents.begin(), contents.end()));
+}
+
+int main()
+{
+    insert_range_before_underfull_head();
+    splice_before_underfull_head();
+    step_back_from_end<unrolled_list<int, 4>>();
+    step_back_from_end<unrolled_list<int, 4, std::allocator<int>, ring_buffer_policy>>();
+    step_back_from_end<unrolled_list<int, 4, std::allocator<int>, indexed_policy>>();
+    reject_damaged_files();
+    sort_keeps_nodes_on_throw();
+    parallel_sort_small_list();
+    sorted_list_matches_set<unrolled_list_policy>("default");
+    sorted_list_matches_set<small_list_policy<>>("small_list");
+    sorted_list_matches_set<ring_buffer_policy>("ring_buffer");
+    persistent_snapshots_stay_unchanged();
+    spsc_queue_recycles_blocks();
+    spsc_queue_threads();
+    mpmc_queue_threads();
+    concurrent_list_threads();
+    concurrent_list_sorted_inserts();
+    soa_segment_scans();
+    random_operations<unrolled_list<int, 6>>("default");
+    random_operations<unrolled_list<int, 6, std::allocator<int>, ring_buffer_policy>>("ring_buffer");
+    random_operations<unrolled_list<int, 6, std::allocator<int>, indexed_policy>>("indexed");
+    random_operations<unrolled_list<int, 6, std::allocator<int>, half_full_policy>>("half_full");
+    random_operations<unrolled_list<int, 6, std::allocator<int>, half_ring_policy>>("half_full ring_buffer");
+    random_operations<unrolled_list<int, 6, std::allocator<int>, half_indexed_policy>>("half_full indexed");
+    random_operations<unrolled_list<int, 6, std::allocator<int>, byte_budget_policy<128, half_full_policy>>>("byte_budget");
+    random_operations<unrolled_list<int, 6, std::allocator<int>, statistics_policy<>>>("statistics");
+    random_operations<unrolled_list<int, 6, std::allocator<int>, small_list_policy<>>>("small_list");
+    random_operations<unrolled_list<int, 6, std::allocator<int>, small_list_policy<half_full_policy>>>("small_list half_full");
+    random_operations<unrolled_list<point, 6, std::allocator<point>, soa_policy<half_full_policy>>>("soa half_full");
+    if (failures)
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+    return failures ? 1 : 0;
+}
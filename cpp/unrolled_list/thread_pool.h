@@ -0,0 +1,172 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool: every worker owns a deque, pops its own work from the
+// back and steals from the front of the others when it runs dry. A thread
+// waiting in run() executes queued tasks too, so nested runs cannot
+// deadlock.
+class thread_pool
+{
+private:
+    struct worker_queue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    struct batch
+    {
+        std::atomic<std::size_t> remaining;
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+
+    std::vector<std::unique_ptr<worker_queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex idle_mutex;
+    std::condition_variable idle;
+    std::atomic<std::size_t> pending{0};
+    std::atomic<std::size_t> next_queue{0};
+    bool stopping = false;
+
+    bool try_pop(std::size_t home, std::function<void()> &task)
+    {
+        {
+            worker_queue &own = *queues[home];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty())
+            {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                pending.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        for (std::size_t i = 1; i < queues.size(); ++i)
+        {
+            worker_queue &victim = *queues[(home + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty())
+            {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                pending.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void worker_loop(std::size_t home)
+    {
+        std::function<void()> task;
+        for (;;)
+        {
+            if (try_pop(home, task))
+            {
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(idle_mutex);
+            idle.wait(lock, [&] { return stopping || pending.load(std::memory_order_relaxed) > 0; });
+            if (stopping && pending.load(std::memory_order_relaxed) == 0)
+                return;
+        }
+    }
+
+public:
+    explicit thread_pool(std::size_t threads = std::thread::hardware_concurrency())
+    {
+        if (threads == 0)
+            threads = 1;
+        for (std::size_t i = 0; i < threads; ++i)
+        {
+            queues.push_back(std::make_unique<worker_queue>());
+        }
+        for (std::size_t i = 0; i < threads; ++i)
+        {
+            workers.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex);
+            stopping = true;
+        }
+        idle.notify_all();
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    std::size_t size() const noexcept { return workers.size(); }
+
+    // Runs task(0) ... task(count - 1) and returns once all have finished.
+    // The first exception thrown by a task is rethrown here.
+    template <typename F>
+    void run(std::size_t count, F task)
+    {
+        if (count == 0)
+            return;
+        auto state = std::make_shared<batch>();
+        state->remaining.store(count, std::memory_order_relaxed);
+        std::size_t first_queue = next_queue.fetch_add(1, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            worker_queue &queue = *queues[(first_queue + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.emplace_back([state, task, i] {
+                try
+                {
+                    task(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> error_lock(state->mutex);
+                    if (!state->error)
+                        state->error = std::current_exception();
+                }
+                if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    std::lock_guard<std::mutex> done_lock(state->mutex);
+                    state->done.notify_all();
+                }
+            });
+            pending.fetch_add(1, std::memory_order_relaxed);
+        }
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex);
+        }
+        idle.notify_all();
+
+        std::function<void()> work;
+        while (state->remaining.load(std::memory_order_acquire) > 0 && try_pop(first_queue % queues.size(), work))
+        {
+            work();
+        }
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait(lock, [&] { return state->remaining.load(std::memory_order_acquire) == 0; });
+        if (state->error)
+            std::rethrow_exception(state->error);
+    }
+};
+
+#endif
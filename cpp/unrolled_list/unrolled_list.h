@@ -2,32 +2,307 @@
 #define UNROLLED_LIST_H
 
 #include "static_array.h"
+#include "ring_array.h"
+#include "soa_array.h"
+#include "node_index.h"
+#include "simd_scan.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
 #include <memory>
+#include <memory_resource>
 #include <iterator>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
 #include <utility>
+#include <vector>
+#if __cplusplus >= 202002L
+#include <span>
+#endif
 
-template <typename T, std::size_t NodeMaxSize = 10, typename Alloc = std::allocator<T>>
+struct unrolled_list_policy
+{
+    template <typename T, std::size_t NodeMaxSize>
+    using storage = StaticArray<T, NodeMaxSize>;
+
+    static constexpr bool indexed = false;
+
+    static constexpr std::size_t min_fill(std::size_t) noexcept { return 0; }
+
+    // Non-zero: size nodes to this many bytes instead of NodeMaxSize elements.
+    static constexpr std::size_t node_bytes = 0;
+
+    // Non-zero: over-align every node, e.g. to a cache line.
+    static constexpr std::size_t node_alignment = 0;
+
+    // Keeps the operation counters reported by stats().
+    static constexpr bool statistics = false;
+
+    // Embeds one node in the list object, used before any heap node.
+    static constexpr bool inline_node = false;
+};
+
+struct ring_buffer_policy : unrolled_list_policy
+{
+    template <typename T, std::size_t NodeMaxSize>
+    using storage = RingArray<T, NodeMaxSize>;
+};
+
+struct indexed_policy : unrolled_list_policy
+{
+    static constexpr bool indexed = true;
+};
+
+struct half_full_policy : unrolled_list_policy
+{
+    static constexpr std::size_t min_fill(std::size_t node_max_size) noexcept { return node_max_size / 2; }
+};
+
+// Picks the per-node capacity so that a node, links and count included,
+// fits in Bytes (256, 4096, ...), and aligns nodes to cache lines.
+template <std::size_t Bytes, typename Base = unrolled_list_policy, std::size_t Alignment = 64>
+struct byte_budget_policy : Base
+{
+    static constexpr std::size_t node_bytes = Bytes;
+    static constexpr std::size_t node_alignment = Alignment;
+};
+
+template <typename Base = unrolled_list_policy>
+struct statistics_policy : Base
+{
+    static constexpr bool statistics = true;
+};
+
+// Stores T column-wise per node; T needs a soa_traits field list. Scans
+// over whole elements (find, count, for_each_segment, ...) see copies
+// gathered from the columns; for_each_field_segment reads one column as is.
+template <typename Base = unrolled_list_policy>
+struct soa_policy : Base
+{
+    template <typename T, std::size_t NodeMaxSize>
+    using storage = SoaArray<T, NodeMaxSize>;
+};
+
+// Lists that fit in one node never touch the allocator.
+template <typename Base = unrolled_list_policy>
+struct small_list_policy : Base
+{
+    static constexpr bool inline_node = true;
+};
+
+// Snapshot returned by unrolled_list::stats(). fill_histogram[i] counts the
+// nodes filled to [i * 10%, (i + 1) * 10%) of capacity; full nodes land in
+// the last bucket. The operation counters are cumulative over the life of
+// the list object, or since the last reset_stats().
+struct unrolled_list_stats
+{
+    std::size_t node_count = 0;
+    std::size_t node_capacity = 0;
+    std::array<std::size_t, 10> fill_histogram{};
+    std::size_t bytes_allocated = 0;
+    std::size_t bytes_used = 0;
+    std::size_t splits = 0;
+    std::size_t node_allocations = 0;
+    std::size_t node_deallocations = 0;
+    std::size_t element_shifts = 0;
+};
+
+// Layout of the files written by unrolled_list::save(): this header, then
+// block_count fixed-size blocks starting at data_offset(). A block is a
+// 64-bit element count followed, at payload_offset(), by one node's
+// elements. Fields are stored in native byte order.
+struct unrolled_list_file_header
+{
+    static constexpr char file_magic[8] = {'U', 'L', 'I', 'S', 'T', 'B', 'I', 'N'};
+    static constexpr std::uint32_t file_version = 1;
+
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t element_size;
+    std::uint64_t element_alignment;
+    std::uint64_t block_capacity;
+    std::uint64_t block_count;
+    std::uint64_t size;
+
+    template <typename T>
+    static unrolled_list_file_header describe(std::uint64_t block_capacity) noexcept
+    {
+        unrolled_list_file_header header{};
+        std::memcpy(header.magic, file_magic, sizeof(file_magic));
+        header.version = file_version;
+        header.element_size = sizeof(T);
+        header.element_alignment = alignof(T);
+        header.block_capacity = block_capacity;
+        return header;
+    }
+
+    template <typename T>
+    bool holds() const noexcept
+    {
+        return std::memcmp(magic, file_magic, sizeof(file_magic)) == 0 && version == file_version &&
+               element_size == sizeof(T) && element_alignment == alignof(T) && block_capacity > 0;
+    }
+
+    std::uint64_t alignment() const noexcept { return std::max<std::uint64_t>(element_alignment, 8); }
+    std::uint64_t align(std::uint64_t offset) const noexcept { return (offset + alignment() - 1) / alignment() * alignment(); }
+    std::uint64_t data_offset() const noexcept { return align(sizeof(unrolled_list_file_header)); }
+    std::uint64_t payload_offset() const noexcept { return align(sizeof(std::uint64_t)); }
+    std::uint64_t block_stride() const noexcept { return align(payload_offset() + block_capacity * element_size); }
+    std::uint64_t file_size() const noexcept { return data_offset() + block_count * block_stride(); }
+
+    // Whether block_count blocks fill exactly `length` bytes. Checked
+    // without overflow, so it is safe on a header read from a damaged file;
+    // call it only once holds<T>() passed.
+    bool spans(std::uint64_t length) const noexcept
+    {
+        constexpr std::uint64_t max = std::numeric_limits<std::uint64_t>::max();
+        if (block_capacity > (max - payload_offset() - alignment()) / element_size || length < data_offset())
+            return false;
+        std::uint64_t stride = block_stride();
+        return block_count <= (length - data_offset()) / stride && file_size() == length;
+    }
+};
+
+template <typename Key, std::size_t NodeMaxSize, typename Compare, typename Alloc, typename Policy>
+class sorted_unrolled_list;
+
+// Defined by the unit tests to walk the node chain.
+struct unrolled_list_test_access;
+
+template <typename T, std::size_t NodeMaxSize = 10, typename Alloc = std::allocator<T>,
+          typename Policy = unrolled_list_policy>
 class unrolled_list
 {
+    template <typename, std::size_t, typename, typename, typename>
+    friend class sorted_unrolled_list;
+    friend struct unrolled_list_test_access;
+
+    using node_hook = std::conditional_t<Policy::indexed, order_statistic_hook, no_index_hook>;
+
+    static constexpr std::size_t node_overhead()
+    {
+        using one = typename Policy::template storage<T, 1>;
+        return (Policy::indexed ? sizeof(node_hook) : 0) + 2 * sizeof(void *) + sizeof(one) - sizeof(T);
+    }
+
+    static constexpr std::size_t budget_capacity()
+    {
+        return Policy::node_bytes > node_overhead() + sizeof(T) ? (Policy::node_bytes - node_overhead()) / sizeof(T) : 1;
+    }
+
+public:
+    static constexpr std::size_t node_capacity = Policy::node_bytes ? budget_capacity() : NodeMaxSize;
+
 private:
-    struct Node
+    static constexpr std::size_t min_fill = Policy::min_fill(node_capacity);
+    static_assert(min_fill <= node_capacity / 2, "Policy::min_fill must not exceed half the node capacity");
+    static_assert(min_fill == 0 || std::is_nothrow_move_constructible_v<T>,
+                  "rebalancing underfull nodes requires a nothrow move constructor");
+    static_assert(!Policy::inline_node || std::is_nothrow_move_constructible_v<T>,
+                  "moving a list with an inline node requires a nothrow move constructor");
+
+    using storage_type = typename Policy::template storage<T, node_capacity>;
+
+    static constexpr std::size_t node_alignment =
+        std::max({Policy::node_alignment, alignof(storage_type), alignof(node_hook), alignof(void *)});
+
+    // Links and element count come first so a node's bookkeeping shares its
+    // first cache line.
+    struct alignas(node_alignment) Node : node_hook
     {
-        StaticArray<T, NodeMaxSize> elements;
         Node *next;
         Node *prev;
+        storage_type elements;
 
         Node() : next(nullptr), prev(nullptr) {}
     };
 
+    static_assert(!Policy::node_bytes || node_capacity == 1 || sizeof(Node) <= Policy::node_bytes,
+                  "node does not fit the byte budget");
+
+    static void prefetch(const Node *node) noexcept
+    {
+#if defined(__GNUC__)
+        if (node)
+            __builtin_prefetch(node);
+#else
+        (void)node;
+#endif
+    }
+
     using NodeAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
     using NodeAllocTraits = std::allocator_traits<NodeAlloc>;
+    using NodeIndex = std::conditional_t<Policy::indexed, order_statistic_index, no_index>;
+
+    struct operation_counters
+    {
+        std::size_t splits = 0;
+        std::size_t node_allocations = 0;
+        std::size_t node_deallocations = 0;
+        std::size_t element_shifts = 0;
+    };
+
+    struct no_operation_counters
+    {
+    };
+
+    using OperationCounters = std::conditional_t<Policy::statistics, operation_counters, no_operation_counters>;
+
+    struct inline_node_slot
+    {
+        alignas(Node) std::byte bytes[sizeof(Node)];
+        bool in_use = false;
+
+        Node *get() noexcept { return std::launder(reinterpret_cast<Node *>(bytes)); }
+        bool holds(const Node *node) const noexcept { return reinterpret_cast<const std::byte *>(node) == bytes; }
+    };
+
+    struct no_inline_node_slot
+    {
+    };
+
+    using InlineNodeSlot = std::conditional_t<Policy::inline_node, inline_node_slot, no_inline_node_slot>;
 
     Node *head;
     Node *tail;
     std::size_t list_size;
     NodeAlloc node_alloc;
+    [[no_unique_address]] NodeIndex node_index;
+    [[no_unique_address]] OperationCounters counters;
+    [[no_unique_address]] InlineNodeSlot inline_slot;
+
+    void record(std::size_t operation_counters::*counter, std::size_t n = 1) noexcept
+    {
+        if constexpr (Policy::statistics)
+            counters.*counter += n;
+    }
+
+    // Counts the elements that move to open or close a gap at index.
+    void record_shift(const Node *node, size_t index) noexcept
+    {
+        if constexpr (Policy::statistics)
+        {
+            size_t after = node->elements.size() - index;
+            counters.element_shifts += storage_type::contiguous ? after : std::min(index, after);
+        }
+    }
 
     Node *allocate_node()
+    {
+        if constexpr (Policy::inline_node)
+        {
+            if (!inline_slot.in_use)
+                return allocate_inline_node();
+        }
+        return allocate_heap_node();
+    }
+
+    Node *allocate_heap_node()
     {
         Node *node = NodeAllocTraits::allocate(node_alloc, 1);
         try
@@ -39,39 +314,451 @@ private:
             NodeAllocTraits::deallocate(node_alloc, node, 1);
             throw;
         }
+        record(&operation_counters::node_allocations);
         return node;
     }
 
     void deallocate_node(Node *node) noexcept
     {
+        if constexpr (Policy::inline_node)
+        {
+            if (inline_slot.holds(node))
+                return release_inline_node();
+        }
+        record(&operation_counters::node_deallocations);
         NodeAllocTraits::destroy(node_alloc, node);
         NodeAllocTraits::deallocate(node_alloc, node, 1);
     }
 
+    Node *allocate_inline_node() noexcept
+    {
+        Node *node = ::new (static_cast<void *>(inline_slot.bytes)) Node();
+        inline_slot.in_use = true;
+        return node;
+    }
+
+    void release_inline_node() noexcept
+    {
+        inline_slot.get()->~Node();
+        inline_slot.in_use = false;
+    }
+
+    // Moves the elements of a linked node into the empty node `to`, which
+    // takes its place in the chain. `from` is left unlinked and empty.
+    void relocate_node(Node *from, Node *to) noexcept
+    {
+        Node *prev = from->prev;
+        unlink_node(from);
+        move_elements(from, 0, from->elements.size(), to, 0);
+        link_after(prev, to);
+        reindex(to);
+    }
+
+    // Called after other's nodes were handed to this list: if other's inline
+    // node came along, its elements move into ours, which must be free.
+    void adopt_inline_node(unrolled_list &other) noexcept
+    {
+        if constexpr (Policy::inline_node)
+        {
+            if (!other.inline_slot.in_use)
+                return;
+            relocate_node(other.inline_slot.get(), allocate_inline_node());
+            other.release_inline_node();
+        }
+    }
+
+    // After the node chains were swapped, each list may be holding the other's
+    // inline node; trade their elements back through a node on the stack.
+    void swap_inline_nodes(unrolled_list &other) noexcept
+    {
+        if constexpr (Policy::inline_node)
+        {
+            if (inline_slot.in_use && other.inline_slot.in_use)
+            {
+                Node spare;
+                relocate_node(other.inline_slot.get(), &spare);
+                other.release_inline_node();
+                other.adopt_inline_node(*this);
+                relocate_node(&spare, allocate_inline_node());
+            }
+            else if (other.inline_slot.in_use)
+                adopt_inline_node(other);
+            else if (inline_slot.in_use)
+                other.adopt_inline_node(*this);
+        }
+    }
+
+    // Moves the inline node's elements to a heap node before nodes are handed
+    // to another list. Returns the replacement, or nullptr.
+    Node *evict_inline_node()
+    {
+        if constexpr (Policy::inline_node)
+        {
+            if (!inline_slot.in_use)
+                return nullptr;
+            Node *node = allocate_heap_node();
+            relocate_node(inline_slot.get(), node);
+            release_inline_node();
+            return node;
+        }
+        return nullptr;
+    }
+
     Node *split_node(Node *node)
     {
         Node *new_node = allocate_node();
         size_t mid = node->elements.size() / 2;
-        for (size_t i = mid; i < node->elements.size(); ++i)
+        try
         {
-            new_node->elements.push_back(node->elements[i]);
+            for (size_t i = mid; i < node->elements.size(); ++i)
+            {
+                new_node->elements.push_back(std::move(node->elements[i]));
+            }
+        }
+        catch (...)
+        {
+            deallocate_node(new_node);
+            throw;
         }
         while (node->elements.size() > mid)
         {
             node->elements.pop_back();
         }
-        new_node->next = node->next;
-        new_node->prev = node;
+        record(&operation_counters::splits);
+        record(&operation_counters::element_shifts, new_node->elements.size());
+        link_after(node, new_node);
+        reindex(node);
+        reindex(new_node);
+        return new_node;
+    }
+
+    void link_after(Node *pos, Node *node) noexcept
+    {
+        node->prev = pos;
+        node->next = pos ? pos->next : head;
         if (node->next)
+            node->next->prev = node;
+        else
+            tail = node;
+        if (pos)
+            pos->next = node;
+        else
+            head = node;
+        if constexpr (Policy::indexed)
         {
-            node->next->prev = new_node;
+            node_index.insert_after(pos, node);
+        }
+    }
+
+    void reindex(Node *node) noexcept
+    {
+        if constexpr (Policy::indexed)
+        {
+            node_index.update(node, node->elements.size());
+        }
+    }
+
+    std::pair<Node *, size_t> locate(size_t pos) const noexcept
+    {
+        if (pos >= list_size)
+            return {nullptr, 0};
+        if constexpr (Policy::indexed)
+        {
+            auto [hook, offset] = node_index.find(pos);
+            return {static_cast<Node *>(hook), offset};
+        }
+        else if (pos < list_size / 2)
+        {
+            Node *node = head;
+            while (pos >= node->elements.size())
+            {
+                pos -= node->elements.size();
+                node = node->next;
+            }
+            return {node, pos};
         }
         else
         {
-            tail = new_node;
+            size_t remaining = list_size - pos;
+            Node *node = tail;
+            while (remaining > node->elements.size())
+            {
+                remaining -= node->elements.size();
+                node = node->prev;
+            }
+            return {node, node->elements.size() - remaining};
         }
-        node->next = new_node;
-        return new_node;
+    }
+
+    void unlink_node(Node *node) noexcept
+    {
+        if constexpr (Policy::indexed)
+        {
+            node_index.erase(node);
+        }
+        if (node->prev)
+            node->prev->next = node->next;
+        else
+            head = node->next;
+        if (node->next)
+            node->next->prev = node->prev;
+        else
+            tail = node->prev;
+        node->next = node->prev = nullptr;
+    }
+
+    // A null node is the end position of `list`; stepping back from it
+    // starts at the tail.
+    static void advance_position(Node *&node, size_t &index, std::ptrdiff_t n, const unrolled_list *list) noexcept
+    {
+        if (n >= 0)
+        {
+            while (node && n > 0)
+            {
+                size_t remaining = node->elements.size() - index;
+                if (static_cast<size_t>(n) < remaining)
+                {
+                    index += n;
+                    return;
+                }
+                n -= remaining;
+                node = node->next;
+                index = 0;
+            }
+            return;
+        }
+        n = -n;
+        if (!node && n > 0 && list && list->list_size)
+        {
+            node = list->tail;
+            index = node->elements.size();
+        }
+        while (node && n > 0)
+        {
+            if (static_cast<size_t>(n) <= index)
+            {
+                index -= n;
+                return;
+            }
+            if (!node->prev)
+            {
+                index = 0;
+                return;
+            }
+            n -= index + 1;
+            node = node->prev;
+            index = node->elements.size() - 1;
+        }
+    }
+
+    static std::ptrdiff_t distance_between(const Node *first, size_t first_index, const Node *last, size_t last_index) noexcept
+    {
+        if (first == last)
+            return static_cast<std::ptrdiff_t>(last_index) - static_cast<std::ptrdiff_t>(first_index);
+        std::ptrdiff_t result = first->elements.size() - first_index;
+        for (const Node *node = first->next; node != last; node = node->next)
+        {
+            result += node->elements.size();
+        }
+        return result + last_index;
+    }
+
+    template <typename It>
+    using RequireInputIterator = std::enable_if_t<
+        std::is_base_of_v<std::input_iterator_tag, typename std::iterator_traits<It>::iterator_category>>;
+
+    class fill_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        fill_iterator(const T *v, size_t p) : value(v), pos(p) {}
+
+        reference operator*() const { return *value; }
+        fill_iterator &operator++()
+        {
+            ++pos;
+            return *this;
+        }
+        fill_iterator operator++(int)
+        {
+            fill_iterator tmp = *this;
+            ++pos;
+            return tmp;
+        }
+        bool operator==(const fill_iterator &other) const { return pos == other.pos; }
+        bool operator!=(const fill_iterator &other) const { return pos != other.pos; }
+
+    private:
+        const T *value;
+        size_t pos;
+    };
+
+    static void append_to_chain(Node *&chain, Node *&chain_tail, Node *node) noexcept
+    {
+        node->prev = chain_tail;
+        node->next = nullptr;
+        if (chain_tail)
+            chain_tail->next = node;
+        else
+            chain = node;
+        chain_tail = node;
+    }
+
+    Node *append_to_chain(Node *&chain, Node *&chain_tail)
+    {
+        Node *node = allocate_node();
+        append_to_chain(chain, chain_tail, node);
+        return node;
+    }
+
+    void free_chain(Node *chain) noexcept
+    {
+        while (chain)
+        {
+            Node *next = chain->next;
+            deallocate_node(chain);
+            chain = next;
+        }
+    }
+
+    // Builds a detached chain of full nodes (only the last may be partial)
+    // straight from the input range.
+    template <typename InputIt>
+    Node *build_chain(InputIt &first, InputIt last, size_t &count)
+    {
+        Node *chain = nullptr;
+        Node *chain_tail = nullptr;
+        try
+        {
+            if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>)
+            {
+                using std::advance;
+                using std::distance;
+                size_t remaining = static_cast<size_t>(distance(first, last));
+                while (remaining)
+                {
+                    size_t chunk = remaining < node_capacity ? remaining : node_capacity;
+                    InputIt chunk_end = first;
+                    advance(chunk_end, chunk);
+                    append_to_chain(chain, chain_tail)->elements.insert(0, first, chunk_end);
+                    count += chunk;
+                    remaining -= chunk;
+                    first = chunk_end;
+                }
+            }
+            else
+            {
+                for (; first != last; ++first)
+                {
+                    if (!chain_tail || chain_tail->elements.full())
+                        append_to_chain(chain, chain_tail);
+                    chain_tail->elements.emplace_back(*first);
+                    ++count;
+                }
+            }
+        }
+        catch (...)
+        {
+            free_chain(chain);
+            throw;
+        }
+        return chain;
+    }
+
+    Node *allocate_spares(size_t n)
+    {
+        Node *spares = nullptr;
+        Node *spares_tail = nullptr;
+        try
+        {
+            for (; n > 0; --n)
+                append_to_chain(spares, spares_tail, allocate_heap_node());
+        }
+        catch (...)
+        {
+            free_chain(spares);
+            throw;
+        }
+        return spares;
+    }
+
+    static Node *take_spare(Node *&spares) noexcept
+    {
+        Node *node = spares;
+        spares = node->next;
+        node->next = nullptr;
+        return node;
+    }
+
+    void free_node(Node *node) noexcept
+    {
+        unlink_node(node);
+        deallocate_node(node);
+    }
+
+    void move_elements(Node *from, size_t first, size_t last, Node *to, size_t pos) noexcept(
+        std::is_nothrow_move_constructible_v<T>)
+    {
+        record_shift(to, pos);
+        to->elements.insert(pos, std::make_move_iterator(from->elements.begin() + first),
+                            std::make_move_iterator(from->elements.begin() + last));
+        from->elements.erase(first, last);
+        record(&operation_counters::element_shifts, last - first);
+        record_shift(from, first);
+    }
+
+    void steal_nodes(unrolled_list &other) noexcept
+    {
+        head = other.head;
+        tail = other.tail;
+        list_size = other.list_size;
+        node_index = std::move(other.node_index);
+        other.head = other.tail = nullptr;
+        other.list_size = 0;
+    }
+
+    // Hands the whole node chain to the caller and leaves the list empty.
+    Node *release_nodes() noexcept
+    {
+        Node *chain = head;
+        head = tail = nullptr;
+        list_size = 0;
+        node_index.clear();
+        return chain;
+    }
+
+    // Replaces the contents with a node-for-node copy of other: each node's
+    // storage is copied in one go (memcpy for trivially copyable T) into
+    // this list's existing nodes first, and new nodes only once those run
+    // out. Node fill is copied as is, so no rebalancing is needed.
+    void copy_nodes(const unrolled_list &other)
+    {
+        Node *spares = release_nodes();
+        try
+        {
+            for (const Node *source = other.list_size ? other.head : nullptr; source; source = source->next)
+            {
+                if (source->elements.empty())
+                    continue;
+                Node *node = spares ? take_spare(spares) : allocate_node();
+                link_after(tail, node);
+                node->elements = source->elements;
+                list_size += node->elements.size();
+                reindex(node);
+            }
+        }
+        catch (...)
+        {
+            free_chain(spares);
+            clear();
+            throw;
+        }
+        free_chain(spares);
     }
 
 public:
@@ -79,21 +766,151 @@ public:
     using allocator_type = Alloc;
     using size_type = std::size_t;
     using difference_type = std::ptrdiff_t;
-    using reference = T &;
-    using const_reference = const T &;
+    using reference = typename storage_type::reference;
+    using const_reference = typename storage_type::const_reference;
     using pointer = typename std::allocator_traits<Alloc>::pointer;
     using const_pointer = typename std::allocator_traits<Alloc>::const_pointer;
 
+    // The contiguous elements of one node.
+    template <typename U>
+    class basic_segment
+    {
+    public:
+        using element_type = U;
+        using value_type = std::remove_cv_t<U>;
+        using size_type = std::size_t;
+        using pointer = U *;
+        using reference = U &;
+        using iterator = U *;
+
+        basic_segment(U *data, size_type size) noexcept : first(data), count(size) {}
+
+        U *data() const noexcept { return first; }
+        size_type size() const noexcept { return count; }
+        bool empty() const noexcept { return count == 0; }
+        U *begin() const noexcept { return first; }
+        U *end() const noexcept { return first + count; }
+        U &operator[](size_type index) const noexcept { return first[index]; }
+
+#ifdef __cpp_lib_span
+        operator std::span<U>() const noexcept { return std::span<U>(first, count); }
+#endif
+
+    private:
+        U *first;
+        size_type count;
+    };
+
+    using segment = basic_segment<T>;
+    using const_segment = basic_segment<const T>;
+
+    // Forward range over the nodes of the list, one segment per node.
+    template <typename U, typename NodePtr>
+    class basic_segment_range
+    {
+    public:
+        class iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = basic_segment<U>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = basic_segment<U>;
+
+            iterator(NodePtr n = nullptr) noexcept : node(n) {}
+
+            reference operator*() const noexcept { return reference(node->elements.data(), node->elements.size()); }
+
+            iterator &operator++() noexcept
+            {
+                node = node->next;
+                return *this;
+            }
+
+            iterator operator++(int) noexcept
+            {
+                iterator tmp = *this;
+                node = node->next;
+                return tmp;
+            }
+
+            bool operator==(const iterator &other) const noexcept { return node == other.node; }
+            bool operator!=(const iterator &other) const noexcept { return node != other.node; }
+
+        private:
+            friend class unrolled_list;
+            NodePtr node;
+        };
+
+        explicit basic_segment_range(NodePtr first) noexcept : first(first) {}
+
+        iterator begin() const noexcept { return iterator(first); }
+        iterator end() const noexcept { return iterator(); }
+
+    private:
+        NodePtr first;
+    };
+
+    using segment_range = basic_segment_range<T, Node *>;
+    using const_segment_range = basic_segment_range<const T, const Node *>;
+
+    // Hooks for segmented_iterator_traits: a list iterator splits into the
+    // node it points into and a raw pointer within that node.
+    struct no_segment_traits
+    {
+        static constexpr bool is_segmented = false;
+    };
+
+    template <typename ListIterator, typename U, typename NodePtr>
+    struct basic_segment_traits
+    {
+        static constexpr bool is_segmented = true;
+        using iterator = ListIterator;
+        using segment_iterator = typename basic_segment_range<U, NodePtr>::iterator;
+        using local_iterator = U *;
+
+        static segment_iterator segment(const iterator &it) noexcept { return segment_iterator(it.node); }
+
+        static local_iterator local(const iterator &it) noexcept
+        {
+            return it.node ? it.node->elements.data() + it.index : nullptr;
+        }
+
+        static local_iterator begin(const segment_iterator &s) noexcept
+        {
+            return s.node ? s.node->elements.data() : nullptr;
+        }
+
+        static local_iterator end(const segment_iterator &s) noexcept
+        {
+            return s.node ? s.node->elements.data() + s.node->elements.size() : nullptr;
+        }
+
+        static iterator compose(const segment_iterator &s, local_iterator local) noexcept
+        {
+            if (!s.node)
+                return iterator();
+            size_type index = static_cast<size_type>(local - s.node->elements.data());
+            if (index < s.node->elements.size())
+                return iterator(const_cast<Node *>(s.node), index);
+            return s.node->next ? iterator(const_cast<Node *>(s.node->next), 0) : iterator();
+        }
+    };
+
     class iterator
     {
     public:
         using iterator_category = std::bidirectional_iterator_tag;
         using value_type = T;
         using difference_type = std::ptrdiff_t;
-        using pointer = T *;
-        using reference = T &;
+        using pointer = typename storage_type::pointer;
+        using reference = typename storage_type::reference;
 
-        iterator(Node *n = nullptr, size_type idx = 0) : node(n), index(idx) {}
+        iterator(Node *n = nullptr, size_type idx = 0, const unrolled_list *owner = nullptr)
+            : node(n), index(idx), list(owner)
+        {
+        }
         reference operator*() const { return node->elements[index]; }
         pointer operator->() const { return &node->elements[index]; }
 
@@ -111,6 +928,7 @@ public:
                     {
                         node = node->next;
                         index = 0;
+                        prefetch(node->next);
                     }
                     else
                     {
@@ -140,6 +958,11 @@ public:
                 node = node->prev;
                 index = node->elements.size() - 1;
             }
+            else if (!node && list && list->list_size)
+            {
+                node = list->tail;
+                index = node->elements.size() - 1;
+            }
             return *this;
         }
 
@@ -153,10 +976,46 @@ public:
         bool operator==(const iterator &other) const { return node == other.node && index == other.index; }
         bool operator!=(const iterator &other) const { return !(*this == other); }
 
+        iterator &operator+=(difference_type n) noexcept
+        {
+            advance_position(node, index, n, list);
+            return *this;
+        }
+
+        iterator &operator-=(difference_type n) noexcept
+        {
+            advance_position(node, index, -n, list);
+            return *this;
+        }
+
+        iterator operator+(difference_type n) const noexcept
+        {
+            iterator tmp = *this;
+            return tmp += n;
+        }
+
+        iterator operator-(difference_type n) const noexcept
+        {
+            iterator tmp = *this;
+            return tmp -= n;
+        }
+
+        friend void advance(iterator &it, difference_type n) noexcept { it += n; }
+
+        friend difference_type distance(const iterator &first, const iterator &last) noexcept { return first.distance_to(last); }
+
+        using segment_traits = std::conditional_t<storage_type::contiguous, basic_segment_traits<iterator, T, Node *>, no_segment_traits>;
+
     private:
         friend class unrolled_list;
         Node *node;
         size_type index;
+        const unrolled_list *list;
+
+        difference_type distance_to(const iterator &last) const noexcept
+        {
+            return distance_between(node, index, last.node, last.index);
+        }
     };
 
     class const_iterator
@@ -165,11 +1024,14 @@ public:
         using iterator_category = std::bidirectional_iterator_tag;
         using value_type = T;
         using difference_type = std::ptrdiff_t;
-        using pointer = const T *;
-        using reference = const T &;
+        using pointer = typename storage_type::const_pointer;
+        using reference = typename storage_type::const_reference;
 
-        const_iterator(Node *n = nullptr, size_type idx = 0) : node(n), index(idx) {}
-        const_iterator(const iterator &it) : node(it.node), index(it.index) {}
+        const_iterator(Node *n = nullptr, size_type idx = 0, const unrolled_list *owner = nullptr)
+            : node(n), index(idx), list(owner)
+        {
+        }
+        const_iterator(const iterator &it) : node(it.node), index(it.index), list(it.list) {}
 
         reference operator*() const { return node->elements[index]; }
         pointer operator->() const { return &node->elements[index]; }
@@ -188,6 +1050,7 @@ public:
                     {
                         node = node->next;
                         index = 0;
+                        prefetch(node->next);
                     }
                     else
                     {
@@ -217,6 +1080,11 @@ public:
                 node = node->prev;
                 index = node->elements.size() - 1;
             }
+            else if (!node && list && list->list_size)
+            {
+                node = list->tail;
+                index = node->elements.size() - 1;
+            }
             return *this;
         }
 
@@ -230,182 +1098,101 @@ public:
         bool operator==(const const_iterator &other) const { return node == other.node && index == other.index; }
         bool operator!=(const const_iterator &other) const { return !(*this == other); }
 
+        const_iterator &operator+=(difference_type n) noexcept
+        {
+            advance_position(node, index, n, list);
+            return *this;
+        }
+
+        const_iterator &operator-=(difference_type n) noexcept
+        {
+            advance_position(node, index, -n, list);
+            return *this;
+        }
+
+        const_iterator operator+(difference_type n) const noexcept
+        {
+            const_iterator tmp = *this;
+            return tmp += n;
+        }
+
+        const_iterator operator-(difference_type n) const noexcept
+        {
+            const_iterator tmp = *this;
+            return tmp -= n;
+        }
+
+        friend void advance(const_iterator &it, difference_type n) noexcept { it += n; }
+
+        friend difference_type distance(const const_iterator &first, const const_iterator &last) noexcept { return first.distance_to(last); }
+
+        using segment_traits = std::conditional_t<storage_type::contiguous, basic_segment_traits<const_iterator, const T, const Node *>, no_segment_traits>;
+
     private:
         friend class unrolled_list;
         Node *node;
         size_type index;
+        const unrolled_list *list;
+
+        difference_type distance_to(const const_iterator &last) const noexcept
+        {
+            return distance_between(node, index, last.node, last.index);
+        }
     };
 
     using reverse_iterator = std::reverse_iterator<iterator>;
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
-    unrolled_list() noexcept : head(nullptr), tail(nullptr), list_size(0), node_alloc(Alloc()) {}
+    unrolled_list() noexcept(std::is_nothrow_default_constructible_v<Alloc>) : head(nullptr), tail(nullptr), list_size(0), node_alloc(Alloc()) {}
     explicit unrolled_list(const Alloc &alloc) noexcept : head(nullptr), tail(nullptr), list_size(0), node_alloc(alloc) {}
 
     unrolled_list(size_type n, const T &value, const Alloc &alloc = Alloc())
         : head(nullptr), tail(nullptr), list_size(0), node_alloc(alloc)
     {
-        try
-        {
-            for (size_type i = 0; i < n; ++i)
-            {
-                push_back(value);
-            }
-        }
-        catch (...)
-        {
-            clear();
-            throw;
-        }
+        insert(cend(), n, value);
     }
 
-    template <typename InputIt>
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
     unrolled_list(InputIt first, InputIt last, const Alloc &alloc = Alloc())
         : head(nullptr), tail(nullptr), list_size(0), node_alloc(alloc)
     {
-        Node *current_node = nullptr;
-        try
-        {
-            while (first != last)
-            {
-                if (!tail || tail->elements.full())
-                {
-                    Node *new_node = allocate_node();
-                    if (!head)
-                        head = tail = new_node;
-                    else
-                    {
-                        tail->next = new_node;
-                        new_node->prev = tail;
-                        tail = new_node;
-                    }
-                    current_node = new_node;
-                }
+        insert(cend(), first, last);
+    }
 
-                try
-                {
-                    tail->elements.push_back(*first);
-                    ++list_size;
-                }
-                catch (...)
-                {
-                    if (current_node && current_node->elements.empty())
-                    {
-                        if (head == tail)
-                            head = tail = nullptr;
-                        else
-                        {
-                            tail = tail->prev;
-                            tail->next = nullptr;
-                        }
-                        deallocate_node(current_node);
-                    }
-                    throw;
-                }
-                ++first;
-            }
-        }
-        catch (...)
-        {
-            clear();
-            throw;
-        }
+    unrolled_list(const unrolled_list &other)
+        : head(nullptr), tail(nullptr), list_size(0),
+          node_alloc(NodeAllocTraits::select_on_container_copy_construction(other.node_alloc))
+    {
+        copy_nodes(other);
+    }
+
+    unrolled_list(const unrolled_list &other, const Alloc &alloc)
+        : head(nullptr), tail(nullptr), list_size(0), node_alloc(alloc)
+    {
+        copy_nodes(other);
     }
 
-    unrolled_list(const unrolled_list &other)
-        : head(nullptr), tail(nullptr), list_size(0),
-          node_alloc(NodeAllocTraits::select_on_container_copy_construction(other.node_alloc))
+    unrolled_list(unrolled_list &&other) noexcept
+        : head(nullptr), tail(nullptr), list_size(0), node_alloc(std::move(other.node_alloc))
     {
-        Node *current_node = nullptr;
-        try
-        {
-            for (const auto &item : other)
-            {
-                if (!tail || tail->elements.full())
-                {
-                    Node *new_node = allocate_node();
-                    if (!head)
-                        head = tail = new_node;
-                    else
-                    {
-                        tail->next = new_node;
-                        new_node->prev = tail;
-                        tail = new_node;
-                    }
-                    current_node = new_node;
-                }
-
-                try
-                {
-                    tail->elements.push_back(item);
-                    ++list_size;
-                }
-                catch (...)
-                {
-                    if (current_node && current_node->elements.empty())
-                    {
-                        if (head == tail)
-                            head = tail = nullptr;
-                        else
-                        {
-                            tail = tail->prev;
-                            tail->next = nullptr;
-                        }
-                        deallocate_node(current_node);
-                    }
-                    throw;
-                }
-            }
-        }
-        catch (...)
-        {
-            clear();
-            throw;
-        }
+        steal_nodes(other);
+        adopt_inline_node(other);
     }
 
-    unrolled_list(const unrolled_list &other, const Alloc &alloc)
+    unrolled_list(unrolled_list &&other, const Alloc &alloc)
         : head(nullptr), tail(nullptr), list_size(0), node_alloc(alloc)
     {
-        Node *current_node = nullptr;
+        if (node_alloc == other.node_alloc)
+        {
+            steal_nodes(other);
+            adopt_inline_node(other);
+            return;
+        }
         try
         {
-            for (const auto &item : other)
+            for (auto &&item : other)
             {
-                if (!tail || tail->elements.full())
-                {
-                    Node *new_node = allocate_node();
-                    if (!head)
-                        head = tail = new_node;
-                    else
-                    {
-                        tail->next = new_node;
-                        new_node->prev = tail;
-                        tail = new_node;
-                    }
-                    current_node = new_node;
-                }
-
-                try
-                {
-                    tail->elements.push_back(item);
-                    ++list_size;
-                }
-                catch (...)
-                {
-                    if (current_node && current_node->elements.empty())
-                    {
-                        if (head == tail)
-                            head = tail = nullptr;
-                        else
-                        {
-                            tail = tail->prev;
-                            tail->next = nullptr;
-                        }
-                        deallocate_node(current_node);
-                    }
-                    throw;
-                }
+                push_back(std::move(item));
             }
         }
         catch (...)
@@ -415,18 +1202,48 @@ public:
         }
     }
 
+    ~unrolled_list()
+    {
+        clear();
+    }
+
     unrolled_list &operator=(const unrolled_list &other)
     {
         if (this != &other)
         {
-            clear();
-            if (NodeAllocTraits::propagate_on_container_copy_assignment::value)
+            if constexpr (NodeAllocTraits::propagate_on_container_copy_assignment::value)
             {
+                if (node_alloc != other.node_alloc)
+                    clear();
                 node_alloc = other.node_alloc;
             }
-            for (const auto &elem : other)
+            copy_nodes(other);
+        }
+        return *this;
+    }
+
+    unrolled_list &operator=(unrolled_list &&other) noexcept(
+        NodeAllocTraits::propagate_on_container_move_assignment::value || NodeAllocTraits::is_always_equal::value)
+    {
+        if (this == &other)
+            return *this;
+        clear();
+        if constexpr (NodeAllocTraits::propagate_on_container_move_assignment::value)
+        {
+            node_alloc = std::move(other.node_alloc);
+            steal_nodes(other);
+            adopt_inline_node(other);
+        }
+        else if (node_alloc == other.node_alloc)
+        {
+            steal_nodes(other);
+            adopt_inline_node(other);
+        }
+        else
+        {
+            for (auto &&elem : other)
             {
-                push_back(elem);
+                push_back(std::move(elem));
             }
         }
         return *this;
@@ -437,12 +1254,12 @@ public:
     reference back() { return tail->elements.back(); }
     const_reference back() const { return tail->elements.back(); }
 
-    iterator begin() noexcept { return head ? iterator(head, 0) : iterator(); }
-    iterator end() noexcept { return iterator(); }
+    iterator begin() noexcept { return list_size ? iterator(head, 0, this) : end(); }
+    iterator end() noexcept { return iterator(nullptr, 0, this); }
     const_iterator begin() const noexcept { return cbegin(); }
     const_iterator end() const noexcept { return cend(); }
-    const_iterator cbegin() const noexcept { return head ? const_iterator(head, 0) : const_iterator(); }
-    const_iterator cend() const noexcept { return const_iterator(); }
+    const_iterator cbegin() const noexcept { return list_size ? const_iterator(head, 0, this) : cend(); }
+    const_iterator cend() const noexcept { return const_iterator(nullptr, 0, this); }
 
     reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
     reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
@@ -451,48 +1268,190 @@ public:
     const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(cend()); }
     const_reverse_iterator crend() const noexcept { return const_reverse_iterator(cbegin()); }
 
+    // Calls f(segment) for every contiguous run of elements, in order. Ring
+    // buffer nodes may yield two runs when their contents wrap; column-wise
+    // nodes yield gathered copies, written back after f returns.
+    template <typename F>
+    void for_each_segment(F f)
+    {
+        for (Node *node = list_size ? head : nullptr; node; node = node->next)
+        {
+            prefetch(node->next);
+            node->elements.for_each_segment([&](T *data, size_type count) { f(segment(data, count)); });
+        }
+    }
+
+    template <typename F>
+    void for_each_segment(F f) const
+    {
+        for (const Node *node = list_size ? head : nullptr; node; node = node->next)
+        {
+            prefetch(node->next);
+            node->elements.for_each_segment([&](const T *data, size_type count) { f(const_segment(data, count)); });
+        }
+    }
+
+    segment_range segments() noexcept
+    {
+        static_assert(storage_type::contiguous, "segments() needs contiguous node storage; use for_each_segment");
+        return segment_range(list_size ? head : nullptr);
+    }
+
+    const_segment_range segments() const noexcept
+    {
+        static_assert(storage_type::contiguous, "segments() needs contiguous node storage; use for_each_segment");
+        return const_segment_range(list_size ? head : nullptr);
+    }
+
+    // Whole-list scans run one kernel per contiguous run; arithmetic element
+    // types use the vectorized kernels from simd_scan.h.
+    iterator find(const T &value)
+    {
+        auto [node, index] = find_position(value);
+        return node ? iterator(node, index, this) : end();
+    }
+
+    const_iterator find(const T &value) const
+    {
+        auto [node, index] = find_position(value);
+        return node ? const_iterator(node, index, this) : cend();
+    }
+
+    size_type count(const T &value) const
+    {
+        size_type result = 0;
+        for_each_segment([&](const_segment seg) { result += simd_count(seg.data(), seg.size(), value); });
+        return result;
+    }
+
+    iterator min_element() { return extreme_position<true>(); }
+    const_iterator min_element() const { return const_cast<unrolled_list *>(this)->template extreme_position<true>(); }
+    iterator max_element() { return extreme_position<false>(); }
+    const_iterator max_element() const { return const_cast<unrolled_list *>(this)->template extreme_position<false>(); }
+
+    T accumulate(T init = T()) const
+    {
+        for_each_segment([&](const_segment seg) { init = simd_accumulate(seg.data(), seg.size(), std::move(init)); });
+        return init;
+    }
+
+    // Column-wise storage (soa_policy): calls f(basic_segment<Field>) with
+    // one field of every element, node by node.
+    template <auto Member, typename F>
+    void for_each_field_segment(F f)
+    {
+        for (Node *node = list_size ? head : nullptr; node; node = node->next)
+        {
+            prefetch(node->next);
+            f(basic_segment<soa_field_t<Member>>(node->elements.template column<Member>(), node->elements.size()));
+        }
+    }
+
+    template <auto Member, typename F>
+    void for_each_field_segment(F f) const
+    {
+        for (const Node *node = list_size ? head : nullptr; node; node = node->next)
+        {
+            prefetch(node->next);
+            f(basic_segment<const soa_field_t<Member>>(node->elements.template column<Member>(), node->elements.size()));
+        }
+    }
+
+    template <auto Member>
+    soa_field_t<Member> accumulate_field(soa_field_t<Member> init = soa_field_t<Member>()) const
+    {
+        for_each_field_segment<Member>([&](auto seg) { init = simd_accumulate(seg.data(), seg.size(), std::move(init)); });
+        return init;
+    }
+
     size_type size() const noexcept { return list_size; }
     size_type max_size() const noexcept { return std::numeric_limits<size_type>::max(); }
     bool empty() const noexcept { return list_size == 0; }
 
-    void push_back(const T &value)
+    reference operator[](size_type pos) noexcept { return *iterator_at(pos); }
+    const_reference operator[](size_type pos) const noexcept { return *iterator_at(pos); }
+
+    reference at(size_type pos)
     {
-        Node *new_node = nullptr;
-        bool node_allocated = false;
+        if (pos >= list_size)
+        {
+            throw std::out_of_range("unrolled_list index out of range");
+        }
+        return *iterator_at(pos);
+    }
 
-        try
+    const_reference at(size_type pos) const
+    {
+        if (pos >= list_size)
+        {
+            throw std::out_of_range("unrolled_list index out of range");
+        }
+        return *iterator_at(pos);
+    }
+
+    iterator iterator_at(size_type pos) noexcept
+    {
+        auto [node, offset] = locate(pos);
+        return node ? iterator(node, offset, this) : end();
+    }
+
+    const_iterator iterator_at(size_type pos) const noexcept
+    {
+        auto [node, offset] = locate(pos);
+        return node ? const_iterator(node, offset, this) : cend();
+    }
+
+    size_type index_of(const_iterator pos) const noexcept
+    {
+        if (!pos.node)
+            return list_size;
+        if constexpr (Policy::indexed)
+        {
+            return node_index.rank(pos.node) + pos.index;
+        }
+        else
         {
-            if (!tail || tail->elements.full())
+            size_type result = pos.index;
+            for (const Node *node = pos.node->prev; node; node = node->prev)
             {
-                new_node = allocate_node();
-                node_allocated = true;
-                if (!head)
-                    head = tail = new_node;
-                else
-                {
-                    new_node->prev = tail;
-                    tail->next = new_node;
-                    tail = new_node;
-                }
+                result += node->elements.size();
             }
+            return result;
+        }
+    }
+
+    void push_back(const T &value)
+    {
+        emplace_back(value);
+    }
+
+    void push_back(T &&value)
+    {
+        emplace_back(std::move(value));
+    }
+
+    template <typename... Args>
+    reference emplace_back(Args &&...args)
+    {
+        Node *new_node = nullptr;
+        if (!tail || tail->elements.full())
+        {
+            new_node = allocate_node();
+            link_after(tail, new_node);
+        }
 
-            tail->elements.push_back(value);
+        try
+        {
+            reference result = tail->elements.emplace_back(std::forward<Args>(args)...);
             ++list_size;
+            reindex(tail);
+            return result;
         }
         catch (...)
         {
-            if (node_allocated)
+            if (new_node)
             {
-                if (tail == new_node)
-                {
-                    if (head == tail)
-                        head = tail = nullptr;
-                    else
-                    {
-                        tail = tail->prev;
-                        tail->next = nullptr;
-                    }
-                }
+                unlink_node(new_node);
                 deallocate_node(new_node);
             }
             throw;
@@ -511,333 +1470,944 @@ public:
         }
         head = tail = nullptr;
         list_size = 0;
+        node_index.clear();
     }
 
     void push_front(const T &value)
     {
+        emplace_front(value);
+    }
+
+    void push_front(T &&value)
+    {
+        emplace_front(std::move(value));
+    }
+
+    template <typename... Args>
+    reference emplace_front(Args &&...args)
+    {
+        Node *new_node = nullptr;
         if (!head || head->elements.full())
         {
-            Node *new_node = allocate_node();
-            if (!head)
+            new_node = allocate_node();
+            link_after(nullptr, new_node);
+        }
+
+        try
+        {
+            reference result = head->elements.emplace_front(std::forward<Args>(args)...);
+            ++list_size;
+            reindex(head);
+            return result;
+        }
+        catch (...)
+        {
+            if (new_node)
             {
-                head = tail = new_node;
+                unlink_node(new_node);
+                deallocate_node(new_node);
             }
-            else
+            throw;
+        }
+    }
+
+    void pop_back() noexcept
+    {
+        if (!list_size)
+            return;
+        tail->elements.pop_back();
+        --list_size;
+        reindex(tail);
+        rebalance(tail, 0);
+    }
+
+    void pop_front() noexcept
+    {
+        if (!list_size)
+            return;
+        head->elements.pop_front();
+        --list_size;
+        reindex(head);
+        rebalance(head, 0);
+    }
+
+    iterator insert(const_iterator pos, const T &value)
+    {
+        return emplace(pos, value);
+    }
+
+    iterator insert(const_iterator pos, T &&value)
+    {
+        return emplace(pos, std::move(value));
+    }
+
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args &&...args)
+    {
+        if (pos == cend())
+        {
+            emplace_back(std::forward<Args>(args)...);
+            return iterator(tail, tail->elements.size() - 1, this);
+        }
+
+        Node *node = pos.node;
+        size_type index = pos.index;
+        if (node->elements.full())
+        {
+            Node *new_node = split_node(node);
+            if (index > node->elements.size())
             {
-                new_node->next = head;
-                head->prev = new_node;
-                head = new_node;
+                index -= node->elements.size();
+                node = new_node;
             }
         }
+
+        record_shift(node, index);
+        node->elements.emplace(index, std::forward<Args>(args)...);
+        ++list_size;
+        reindex(node);
+        return iterator(node, index, this);
+    }
+
+    iterator insert(size_type pos, const T &value)
+    {
+        return emplace(iterator_at(pos), value);
+    }
+
+    iterator insert(size_type pos, T &&value)
+    {
+        return emplace(iterator_at(pos), std::move(value));
+    }
+
+    iterator insert(const_iterator pos, size_type count, const T &value)
+    {
+        return insert(pos, fill_iterator(&value, 0), fill_iterator(&value, count));
+    }
+
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    iterator insert(const_iterator pos, InputIt first, InputIt last)
+    {
+        if (first == last)
+            return make_iterator(pos.node, pos.index);
+
+        Node *spares = allocate_spares(splits_node(pos) ? 1 : 0);
+        size_type count = 0;
+        Node *chain;
         try
         {
-            head->elements.insert(0, value);
-            ++list_size;
+            chain = build_chain(first, last, count);
+        }
+        catch (...)
+        {
+            free_chain(spares);
+            throw;
+        }
+        iterator result = attach_chain(pos, chain, count, spares);
+        free_chain(spares);
+        return result;
+    }
+
+    iterator erase(const_iterator pos) noexcept
+    {
+        if (pos == cend() || !pos.node)
+            return end();
+
+        Node *node = pos.node;
+        node->elements.erase(pos.index);
+        record_shift(node, pos.index);
+        --list_size;
+        reindex(node);
+        return rebalance(node, pos.index);
+    }
+
+    iterator erase(size_type pos) noexcept
+    {
+        return erase(iterator_at(pos));
+    }
+
+    iterator erase(const_iterator first, const_iterator last) noexcept
+    {
+        if (first == last)
+            return iterator(first.node, first.index, this);
+
+        Node *node = first.node;
+        if (node == last.node)
+        {
+            node->elements.erase(first.index, last.index);
+            record_shift(node, first.index);
+            list_size -= last.index - first.index;
+            reindex(node);
+            return rebalance(node, first.index);
+        }
+
+        size_type removed = node->elements.size() - first.index;
+        node->elements.erase(first.index, node->elements.size());
+        reindex(node);
+        for (Node *current = node->next; current != last.node;)
+        {
+            Node *next = current->next;
+            removed += current->elements.size();
+            free_node(current);
+            current = next;
+        }
+        if (last.node)
+        {
+            removed += last.index;
+            last.node->elements.erase(0, last.index);
+            record_shift(last.node, 0);
+            reindex(last.node);
+        }
+        list_size -= removed;
+
+        Node *pos_node = last.node;
+        size_type pos_index = 0;
+        if (last.node)
+        {
+            rebalance(last.node, pos_node, pos_index);
+        }
+        rebalance(node, pos_node, pos_index);
+        return make_iterator(pos_node, pos_index);
+    }
+
+    void compact() noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (!list_size)
+        {
+            clear();
+            return;
         }
-        catch (...)
+        Node *dst = head;
+        Node *src = dst->next;
+        while (src)
         {
-            if (head->elements.empty() && head != tail)
+            size_t take = node_capacity - dst->elements.size();
+            if (take > src->elements.size())
+                take = src->elements.size();
+            if (take)
             {
-                head->next->prev = nullptr;
-                head = head->next;
-                deallocate_node(head->prev);
+                move_elements(src, 0, take, dst, dst->elements.size());
+                reindex(dst);
+            }
+            if (src->elements.empty())
+            {
+                Node *next = src->next;
+                free_node(src);
+                src = next;
+            }
+            else
+            {
+                reindex(src);
+                dst = src;
+                src = src->next;
             }
-            throw;
         }
     }
 
-    void pop_back() noexcept
+    void shrink_to_fit() noexcept(std::is_nothrow_move_constructible_v<T>)
     {
-        if (!tail)
-            return;
-        tail->elements.pop_back();
-        --list_size;
-        if (tail->elements.empty() && head != tail)
-        {
-            Node *to_delete = tail;
-            tail = tail->prev;
-            tail->next = nullptr;
-            deallocate_node(to_delete);
-        }
+        compact();
     }
 
-    void pop_front() noexcept
+    // Occupancy is measured by walking the nodes; the operation counters
+    // are only kept when the policy enables statistics.
+    unrolled_list_stats stats() const noexcept
     {
-        if (!head)
-            return;
-        head->elements.erase(0);
-        --list_size;
-        if (head->elements.empty() && head != tail)
+        static_assert(Policy::statistics, "stats() requires a statistics_policy");
+        unrolled_list_stats result;
+        result.node_capacity = node_capacity;
+        for (const Node *node = list_size ? head : nullptr; node; node = node->next)
         {
-            Node *to_delete = head;
-            head = head->next;
-            head->prev = nullptr;
-            deallocate_node(to_delete);
+            prefetch(node->next);
+            ++result.node_count;
+            size_t bucket = node->elements.size() * result.fill_histogram.size() / node_capacity;
+            ++result.fill_histogram[std::min(bucket, result.fill_histogram.size() - 1)];
         }
+        result.bytes_allocated = result.node_count * sizeof(Node);
+        result.bytes_used = list_size * sizeof(T);
+        result.splits = counters.splits;
+        result.node_allocations = counters.node_allocations;
+        result.node_deallocations = counters.node_deallocations;
+        result.element_shifts = counters.element_shifts;
+        return result;
     }
 
-    iterator insert(const_iterator pos, const T &value)
+    void reset_stats() noexcept
     {
-        if (pos == cend())
-        {
-            push_back(value);
-            return iterator(tail, tail->elements.size() - 1);
-        }
+        static_assert(Policy::statistics, "reset_stats() requires a statistics_policy");
+        counters = OperationCounters();
+    }
 
-        Node *node = pos.node;
-        if (!node)
+    // Writes every node as one block of an unrolled_list_file_header file,
+    // which load() reads back and mapped_unrolled_list maps in place.
+    void save(const char *path) const
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "save() requires a trivially copyable T");
+        unrolled_list_file_header header = unrolled_list_file_header::describe<T>(node_capacity);
+        header.size = list_size;
+        for (const Node *node = list_size ? head : nullptr; node; node = node->next)
         {
-            push_front(value);
-            return iterator(head, 0);
+            header.block_count += !node->elements.empty();
         }
 
-        if (node->elements.full())
+        std::unique_ptr<std::FILE, int (*)(std::FILE *)> file(std::fopen(path, "wb"), &std::fclose);
+        if (!file)
+            throw std::runtime_error("unrolled_list cannot open file for writing");
+        std::vector<std::byte> block(header.data_offset());
+        std::memcpy(block.data(), &header, sizeof(header));
+        bool ok = std::fwrite(block.data(), 1, block.size(), file.get()) == block.size();
+
+        block.assign(header.block_stride(), std::byte());
+        for (const Node *node = list_size ? head : nullptr; ok && node; node = node->next)
         {
-            Node *new_node = split_node(node);
-            if (pos.index > node->elements.size())
+            if (node->elements.empty())
+                continue;
+            std::uint64_t count = node->elements.size();
+            std::memcpy(block.data(), &count, sizeof(count));
+            std::byte *payload = block.data() + header.payload_offset();
+            if constexpr (storage_type::contiguous)
             {
-                node = new_node;
-                pos = const_iterator(new_node, pos.index - node->elements.size());
+                std::memcpy(payload, node->elements.data(), count * sizeof(T));
+            }
+            else
+            {
+                for (const T item : node->elements)
+                {
+                    std::memcpy(payload, &item, sizeof(T));
+                    payload += sizeof(T);
+                }
             }
+            ok = std::fwrite(block.data(), 1, block.size(), file.get()) == block.size();
         }
+        if (!ok || std::fclose(file.release()) != 0)
+            throw std::runtime_error("unrolled_list cannot write file");
+    }
 
-        try
+    // Replaces the contents with a list written by save(). The file's block
+    // capacity need not match node_capacity.
+    void load(const char *path)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "load() requires a trivially copyable T");
+        std::unique_ptr<std::FILE, int (*)(std::FILE *)> file(std::fopen(path, "rb"), &std::fclose);
+        if (!file)
+            throw std::runtime_error("unrolled_list cannot open file for reading");
+        unrolled_list_file_header header;
+        long length = std::fseek(file.get(), 0, SEEK_END) == 0 ? std::ftell(file.get()) : -1;
+        if (length < 0 || std::fseek(file.get(), 0, SEEK_SET) != 0 ||
+            std::fread(&header, sizeof(header), 1, file.get()) != 1 || !header.holds<T>() ||
+            !header.spans(static_cast<std::uint64_t>(length)) ||
+            std::fseek(file.get(), static_cast<long>(header.data_offset()), SEEK_SET) != 0)
+            throw std::runtime_error("unrolled_list file has a different format");
+        if (header.block_count == 0)
         {
-            node->elements.insert(pos.index, value);
-            ++list_size;
-            return iterator(node, pos.index);
+            if (header.size != 0)
+                throw std::runtime_error("unrolled_list file is corrupt");
+            clear();
+            return;
         }
-        catch (...)
+        // Only a block that fits in the file may size the buffers below.
+        if (header.block_stride() > static_cast<std::uint64_t>(length) - header.data_offset())
+            throw std::runtime_error("unrolled_list file has a different format");
+
+        unrolled_list loaded(node_alloc);
+        std::vector<std::byte> block(header.block_stride());
+        std::vector<T> items(header.block_capacity);
+        for (std::uint64_t b = 0; b < header.block_count; ++b)
         {
-            throw;
+            std::uint64_t count;
+            if (std::fread(block.data(), 1, block.size(), file.get()) != block.size())
+                throw std::runtime_error("unrolled_list file is truncated");
+            std::memcpy(&count, block.data(), sizeof(count));
+            if (count > header.block_capacity)
+                throw std::runtime_error("unrolled_list file is corrupt");
+            std::memcpy(items.data(), block.data() + header.payload_offset(), count * sizeof(T));
+            loaded.insert(loaded.cend(), items.begin(), items.begin() + static_cast<std::ptrdiff_t>(count));
         }
+        if (loaded.size() != header.size)
+            throw std::runtime_error("unrolled_list file is corrupt");
+        swap(loaded);
     }
 
-    iterator insert(const_iterator pos, size_type count, const T &value)
+    void splice(const_iterator pos, unrolled_list &other)
     {
-        iterator result;
-        if (count == 0)
-            return pos.node ? iterator(pos.node, pos.index) : end();
+        splice(pos, other, other.cbegin(), other.cend());
+    }
 
-        if (pos == cend())
+    void splice(const_iterator pos, unrolled_list &other, const_iterator first, const_iterator last)
+    {
+        if (first == last)
+            return;
+        if (node_alloc != other.node_alloc)
         {
-            for (size_type i = 0; i < count; ++i)
-            {
-                push_back(value);
-            }
-            return iterator(tail, tail->elements.size() - count);
+            insert(pos, std::make_move_iterator(iterator(first.node, first.index)),
+                   std::make_move_iterator(iterator(last.node, last.index)));
+            other.erase(first, last);
+            return;
         }
 
-        Node *node = pos.node;
-        if (!node)
+        bool self = this == &other;
+        if constexpr (Policy::inline_node)
         {
-            for (size_type i = 0; i < count; ++i)
+            if (!self && other.inline_slot.in_use)
             {
-                push_front(value);
+                bool first_inline = other.inline_slot.holds(first.node);
+                bool last_inline = other.inline_slot.holds(last.node);
+                Node *moved = other.evict_inline_node();
+                if (first_inline)
+                    first = const_iterator(moved, first.index);
+                if (last_inline)
+                    last = const_iterator(moved, last.index);
             }
-            return iterator(head, 0);
         }
+        size_type pos_offset = self ? index_of(pos) : 0;
+        size_type first_offset = self ? index_of(first) : 0;
+        size_t pieces = first.node == last.node ? 1 : (first.index > 0) + (last.node && last.index > 0);
+        Node *spares = allocate_spares(pieces + (self || splits_node(pos) ? 1 : 0));
+
+        size_type count = 0;
+        Node *chain = other.detach_range(first, last, count, spares);
+        if (self)
+            pos = iterator_at(pos_offset > first_offset ? pos_offset - count : pos_offset);
+        attach_chain(pos, chain, count, spares);
+        free_chain(spares);
+    }
+
+    unrolled_list split_at(const_iterator pos)
+    {
+        unrolled_list result(get_allocator());
+        result.splice(result.cend(), *this, pos, cend());
+        return result;
+    }
+
+    void merge(unrolled_list &other)
+    {
+        merge(other, std::less<>());
+    }
 
-        while (node->elements.size() + count > NodeMaxSize)
+    // Stable merge of two sorted lists. Whole nodes that fall between two
+    // elements of the other list are relinked; only interleaved stretches
+    // are moved element by element, into nodes recycled from the inputs.
+    template <typename Compare>
+    void merge(unrolled_list &other, Compare comp)
+    {
+        if (this == &other || other.empty())
+            return;
+        if (node_alloc != other.node_alloc)
         {
-            node = split_node(node);
-            if (pos.index > node->elements.size())
-            {
-                pos.index -= node->elements.size();
-                node = node->next;
-            }
+            unrolled_list moved(std::move(other), get_allocator());
+            other.clear();
+            merge(moved, comp);
+            return;
         }
 
+        other.evict_inline_node();
+        merge_cursor a{release_nodes(), 0};
+        merge_cursor b{other.release_nodes(), 0};
+        Node *out = nullptr;
+        Node *out_tail = nullptr;
+        Node *spares = nullptr;
         try
         {
-            for (size_type i = 0; i < count; ++i)
+            settle(a, spares);
+            settle(b, spares);
+            while (a.node && b.node)
             {
-                node->elements.insert(pos.index + i, value);
+                bool from_b = comp(b.node->elements[b.index], a.node->elements[a.index]);
+                merge_cursor &src = from_b ? b : a;
+                const T &rival = from_b ? a.node->elements[a.index] : b.node->elements[b.index];
+                if (src.index == 0 && (!out_tail || out_tail->elements.size() * 2 >= node_capacity) &&
+                    (from_b ? comp(src.node->elements.back(), rival) : !comp(rival, src.node->elements.back())))
+                {
+                    Node *node = src.node;
+                    src.node = node->next;
+                    append_to_chain(out, out_tail, node);
+                    continue;
+                }
+                if (!out_tail || out_tail->elements.full())
+                {
+                    if (spares)
+                        append_to_chain(out, out_tail, take_spare(spares));
+                    else
+                        append_to_chain(out, out_tail);
+                }
+                out_tail->elements.emplace_back(std::move(src.node->elements[src.index]));
+                ++src.index;
+                settle(src, spares);
             }
-            list_size += count;
-            return iterator(node, pos.index);
         }
         catch (...)
         {
+            finish_merge(a, b, out, out_tail, spares);
             throw;
         }
+        finish_merge(a, b, out, out_tail, spares);
     }
-    template <typename InputIt>
-    iterator insert(const_iterator pos, InputIt first, InputIt last)
+
+    void sort()
     {
-        iterator result;
-        if (pos == cend())
+        sort(std::less<>());
+    }
+
+    // Each node is sorted in place as a run, then runs are merged bottom-up
+    // with merge(), so the extra memory stays at a few nodes per level.
+    template <typename Compare>
+    void sort(Compare comp)
+    {
+        sort_runs(comp, [&](Node *node) { std::sort(node->elements.begin(), node->elements.end(), comp); });
+    }
+
+    void stable_sort()
+    {
+        stable_sort(std::less<>());
+    }
+
+    template <typename Compare>
+    void stable_sort(Compare comp)
+    {
+        sort_runs(comp, [&](Node *node) { std::stable_sort(node->elements.begin(), node->elements.end(), comp); });
+    }
+
+    void swap(unrolled_list &other) noexcept
+    {
+        Node *tmp_head = head;
+        Node *tmp_tail = tail;
+        std::size_t tmp_size = list_size;
+        NodeAlloc tmp_alloc = node_alloc;
+
+        head = other.head;
+        tail = other.tail;
+        list_size = other.list_size;
+        if constexpr (NodeAllocTraits::propagate_on_container_swap::value)
         {
-            for (; first != last; ++first)
-            {
-                push_back(*first);
-            }
-            return iterator(tail, tail->elements.size() - std::distance(first, last));
+            node_alloc = other.node_alloc;
         }
 
-        Node *node = pos.node;
-        if (!node)
+        other.head = tmp_head;
+        other.tail = tmp_tail;
+        other.list_size = tmp_size;
+        if constexpr (NodeAllocTraits::propagate_on_container_swap::value)
         {
-            for (; first != last; ++first)
-            {
-                push_front(*first);
-            }
-            return iterator(head, 0);
+            other.node_alloc = tmp_alloc;
         }
+        std::swap(node_index, other.node_index);
+        swap_inline_nodes(other);
+    }
 
-        size_t count = std::distance(first, last);
-        while (node->elements.size() + count > NodeMaxSize)
+    bool operator==(const unrolled_list &other) const
+    {
+        if (size() != other.size())
+            return false;
+        auto it1 = begin();
+        auto it2 = other.begin();
+        for (; it1 != end(); ++it1, ++it2)
         {
-            node = split_node(node);
+            if (*it1 != *it2)
+                return false;
         }
+        return true;
+    }
 
-        try
+    bool operator!=(const unrolled_list &other) const { return !(*this == other); }
+    allocator_type get_allocator() const noexcept { return node_alloc; }
+
+private:
+    struct merge_cursor
+    {
+        Node *node;
+        size_t index;
+    };
+
+    // Skips past fully consumed input nodes, recycling them as spares.
+    static void settle(merge_cursor &cursor, Node *&spares) noexcept
+    {
+        while (cursor.node && cursor.index == cursor.node->elements.size())
+        {
+            Node *done = cursor.node;
+            cursor.node = done->next;
+            cursor.index = 0;
+            done->elements.clear();
+            done->next = spares;
+            spares = done;
+        }
+    }
+
+    void finish_merge(merge_cursor &a, merge_cursor &b, Node *out, Node *out_tail, Node *spares) noexcept
+    {
+        merge_cursor *cursors[] = {&a, &b};
+        for (merge_cursor *cursor : cursors)
         {
-            for (; first != last; ++first)
+            settle(*cursor, spares);
+            if (cursor->node)
+                cursor->node->elements.erase(0, cursor->index);
+            for (Node *node = cursor->node; node;)
             {
-                node->elements.insert(pos.index++, *first);
-                ++list_size;
+                Node *next = node->next;
+                append_to_chain(out, out_tail, node);
+                node = next;
             }
-            return iterator(node, pos.index - count);
         }
-        catch (...)
+        for (Node *node = out; node;)
         {
-            throw;
+            Node *next = node->next;
+            list_size += node->elements.size();
+            link_after(tail, node);
+            reindex(node);
+            node = next;
         }
+        free_chain(spares);
+        restore_fill();
     }
 
-    iterator erase(const_iterator pos) noexcept
+    std::pair<Node *, size_t> find_position(const T &value) const
     {
-        if (pos == cend() || !pos.node)
-            return end();
+        for (Node *node = list_size ? head : nullptr; node; node = node->next)
+        {
+            prefetch(node->next);
+            size_t offset = 0;
+            size_t found = node->elements.size();
+            std::as_const(node->elements).for_each_segment([&](const T *data, size_t n) {
+                if (found == node->elements.size())
+                {
+                    size_t index = simd_find(data, n, value);
+                    if (index < n)
+                        found = offset + index;
+                }
+                offset += n;
+            });
+            if (found < node->elements.size())
+                return {node, found};
+        }
+        return {nullptr, 0};
+    }
 
-        Node *node = pos.node;
-        node->elements.erase(pos.index);
-        --list_size;
+    template <bool Min>
+    iterator extreme_position()
+    {
+        Node *best_node = nullptr;
+        size_t best_index = 0;
+        for (Node *node = list_size ? head : nullptr; node; node = node->next)
+        {
+            prefetch(node->next);
+            size_t offset = 0;
+            std::as_const(node->elements).for_each_segment([&](const T *data, size_t n) {
+                size_t index = Min ? simd_min_index(data, n) : simd_max_index(data, n);
+                // The run may be a gathered copy (soa_policy), so the best
+                // element so far is read back from its node.
+                if (!best_node || (Min ? data[index] < std::as_const(best_node->elements)[best_index]
+                                       : std::as_const(best_node->elements)[best_index] < data[index]))
+                {
+                    best_node = node;
+                    best_index = offset + index;
+                }
+                offset += n;
+            });
+        }
+        return best_node ? iterator(best_node, best_index, this) : end();
+    }
 
-        iterator next_it(node, pos.index);
-        if (node->elements.empty() && head != tail)
+    // Bins hold sorted lists of 1, 2, 4, ... node runs, as in the classic
+    // std::list::sort. On an exception every element is put back, unsorted:
+    // higher bins hold earlier runs, so they go first, then the carry, then
+    // the nodes not reached yet.
+    template <typename Compare, typename SortNode>
+    void sort_runs(Compare comp, SortNode sort_node)
+    {
+        if (!list_size)
+            return;
+        evict_inline_node();
+        unrolled_list carry(get_allocator());
+        std::vector<unrolled_list> bins;
+        try
         {
-            if (node == head)
+            while (list_size)
             {
-                head = head->next;
-                head->prev = nullptr;
+                Node *node = head;
+                list_size -= node->elements.size();
+                unlink_node(node);
+                carry.link_after(nullptr, node);
+                carry.reindex(node);
+                carry.list_size = node->elements.size();
+                sort_node(node);
+
+                size_t bin = 0;
+                for (; bin < bins.size() && !bins[bin].empty(); ++bin)
+                {
+                    bins[bin].merge(carry, comp);
+                    carry.swap(bins[bin]);
+                }
+                if (bin == bins.size())
+                    bins.emplace_back(get_allocator());
+                carry.swap(bins[bin]);
             }
-            else if (node == tail)
+            for (size_t bin = 1; bin < bins.size(); ++bin)
             {
-                tail = tail->prev;
-                tail->next = nullptr;
+                bins[bin].merge(bins[bin - 1], comp);
             }
-            else
+            swap(bins.back());
+        }
+        catch (...)
+        {
+            splice(cbegin(), carry);
+            for (unrolled_list &bin : bins)
             {
-                node->prev->next = node->next;
-                node->next->prev = node->prev;
+                splice(cbegin(), bin);
             }
-            deallocate_node(node);
-            if (next_it.node->next)
+            throw;
+        }
+    }
+
+    static bool splits_node(const_iterator pos) noexcept
+    {
+        return pos.node && pos.index > 0 && pos.index < pos.node->elements.size();
+    }
+
+    // Links a detached chain holding `count` elements in front of pos; a node
+    // split at pos takes its new node from `spares`.
+    iterator attach_chain(const_iterator pos, Node *chain, size_type count, Node *&spares) noexcept
+    {
+        Node *before = pos.node ? pos.node->prev : tail;
+        if (pos.node && pos.index > 0)
+        {
+            before = pos.node;
+            if (pos.index < pos.node->elements.size())
             {
-                next_it = iterator(next_it.node->next, 0);
+                Node *split = take_spare(spares);
+                move_elements(pos.node, pos.index, pos.node->elements.size(), split, 0);
+                link_after(pos.node, split);
+                reindex(pos.node);
+                reindex(split);
             }
         }
-        else if (next_it.index >= node->elements.size() && node->next)
+
+        // The seam spans before, the chain, the split-off node and the node
+        // after pos; two underfull neighbours may need more than one pass.
+        Node *chain_last = before;
+        size_t seam = 3;
+        for (Node *node = chain; node;)
         {
-            next_it = iterator(node->next, 0);
+            Node *next = node->next;
+            link_after(chain_last, node);
+            reindex(node);
+            chain_last = node;
+            node = next;
+            ++seam;
         }
+        list_size += count;
 
-        return next_it;
+        Node *pos_node = chain;
+        size_type pos_index = 0;
+        restore_fill(before ? before : head, seam, pos_node, pos_index);
+        return make_iterator(pos_node, pos_index);
     }
 
-    iterator erase(const_iterator first, const_iterator last) noexcept
+    // Cuts [first, last) out of the list as a detached chain. Interior nodes
+    // are unlinked whole; a partially covered node at either end gives up its
+    // share to a node taken from `spares`.
+    Node *detach_range(const_iterator first, const_iterator last, size_type &count, Node *&spares) noexcept
     {
-        if (first == last)
-            return iterator(first.node, first.index);
-
         Node *node = first.node;
-        size_t count = 0;
-        while (first != last)
+        Node *pos_node = last.node;
+        size_t pos_index = 0;
+        if (node == last.node)
+        {
+            Node *chain = take_spare(spares);
+            move_elements(node, first.index, last.index, chain, 0);
+            count = last.index - first.index;
+            list_size -= count;
+            reindex(node);
+            rebalance(node, pos_node, pos_index);
+            return chain;
+        }
+
+        Node *chain = nullptr;
+        Node *chain_tail = nullptr;
+        if (first.index > 0)
+        {
+            Node *piece = take_spare(spares);
+            count += node->elements.size() - first.index;
+            move_elements(node, first.index, node->elements.size(), piece, 0);
+            reindex(node);
+            append_to_chain(chain, chain_tail, piece);
+            node = node->next;
+        }
+        while (node != last.node)
+        {
+            Node *next = node->next;
+            count += node->elements.size();
+            unlink_node(node);
+            append_to_chain(chain, chain_tail, node);
+            node = next;
+        }
+        if (last.node && last.index > 0)
         {
-            node->elements.erase(first.index);
-            ++first;
-            ++count;
+            Node *piece = take_spare(spares);
+            count += last.index;
+            move_elements(last.node, 0, last.index, piece, 0);
+            reindex(last.node);
+            append_to_chain(chain, chain_tail, piece);
         }
         list_size -= count;
 
-        iterator next_it(node, first.index);
-        if (node->elements.empty() && head != tail)
+        if (last.node)
+            rebalance(last.node, pos_node, pos_index);
+        if (first.index > 0)
+            rebalance(first.node, pos_node, pos_index);
+        return chain;
+    }
+
+    iterator make_iterator(Node *node, size_t index) noexcept
+    {
+        if (node && index >= node->elements.size())
+        {
+            node = node->next;
+            index = 0;
+        }
+        return node ? iterator(node, index, this) : end();
+    }
+
+    iterator rebalance(Node *node, size_t index) noexcept
+    {
+        Node *pos_node = node;
+        rebalance(node, pos_node, index);
+        return make_iterator(pos_node, index);
+    }
+
+    // Restores the fill invariant after elements were removed from `node`,
+    // remapping the position (pos_node, pos_index) across any moved elements.
+    // Returns the node now holding node's elements, or its successor if node
+    // was empty and freed.
+    Node *rebalance(Node *node, Node *&pos_node, size_t &pos_index) noexcept
+    {
+        if (!underfull(node))
+            return node;
+        if (node->elements.empty())
         {
-            if (node == head)
+            Node *next = node->next;
+            if (pos_node == node)
             {
-                head = head->next;
-                head->prev = nullptr;
+                pos_node = next;
+                pos_index = 0;
             }
-            else if (node == tail)
+            free_node(node);
+            return next;
+        }
+        if constexpr (min_fill > 0)
+        {
+            size_t size = node->elements.size();
+            if (Node *next = node->next)
             {
-                tail = tail->prev;
-                tail->next = nullptr;
+                size_t next_size = next->elements.size();
+                size_t take = size + next_size <= node_capacity ? next_size : (next_size - size) / 2;
+                move_elements(next, 0, take, node, size);
+                if (pos_node == next)
+                {
+                    if (pos_index < take)
+                    {
+                        pos_node = node;
+                        pos_index += size;
+                    }
+                    else
+                    {
+                        pos_index -= take;
+                    }
+                }
+                if (next->elements.empty())
+                    free_node(next);
+                else
+                    reindex(next);
+                reindex(node);
             }
             else
             {
-                node->prev->next = node->next;
-                node->next->prev = node->prev;
-            }
-            deallocate_node(node);
-            if (next_it.node->next)
-            {
-                next_it = iterator(next_it.node->next, 0);
+                Node *prev = node->prev;
+                size_t prev_size = prev->elements.size();
+                if (prev_size + size <= node_capacity)
+                {
+                    move_elements(node, 0, size, prev, prev_size);
+                    if (pos_node == node)
+                    {
+                        pos_node = prev;
+                        pos_index += prev_size;
+                    }
+                    free_node(node);
+                    reindex(prev);
+                    return prev;
+                }
+                else
+                {
+                    size_t take = (prev_size - size) / 2;
+                    move_elements(prev, prev_size - take, prev_size, node, 0);
+                    if (pos_node == node)
+                    {
+                        pos_index += take;
+                    }
+                    else if (pos_node == prev && pos_index >= prev_size - take)
+                    {
+                        pos_node = node;
+                        pos_index -= prev_size - take;
+                    }
+                    reindex(prev);
+                    reindex(node);
+                }
             }
         }
-        else if (next_it.index >= node->elements.size() && node->next)
-        {
-            next_it = iterator(node->next, 0);
-        }
-
-        return next_it;
+        return node;
     }
 
-    void swap(unrolled_list &other) noexcept
+    bool underfull(const Node *node) const noexcept
     {
-        Node *tmp_head = head;
-        Node *tmp_tail = tail;
-        std::size_t tmp_size = list_size;
-        NodeAlloc tmp_alloc = node_alloc;
-
-        head = other.head;
-        tail = other.tail;
-        list_size = other.list_size;
-        if (NodeAllocTraits::propagate_on_container_swap::value)
-        {
-            node_alloc = other.node_alloc;
-        }
+        return head != tail && node->elements.size() < (min_fill ? min_fill : 1);
+    }
 
-        other.head = tmp_head;
-        other.tail = tmp_tail;
-        other.list_size = tmp_size;
-        if (NodeAllocTraits::propagate_on_container_swap::value)
+    // Rebalances the `span` nodes starting at `node` until each meets
+    // min_fill, after nodes were relinked wholesale. A node merged with an
+    // underfull neighbour is revisited, so runs of small nodes settle too.
+    void restore_fill(Node *node, size_t span, Node *&pos_node, size_t &pos_index) noexcept
+    {
+        while (node && span)
         {
-            other.node_alloc = tmp_alloc;
+            if (underfull(node))
+            {
+                node = rebalance(node, pos_node, pos_index);
+                continue;
+            }
+            node = node->next;
+            --span;
         }
     }
 
-    bool operator==(const unrolled_list &other) const
+    void restore_fill() noexcept
     {
-        if (size() != other.size())
-            return false;
-        auto it1 = begin();
-        auto it2 = other.begin();
-        for (; it1 != end(); ++it1, ++it2)
+        if constexpr (min_fill > 0)
         {
-            if (*it1 != *it2)
-                return false;
+            Node *pos_node = nullptr;
+            size_t pos_index = 0;
+            restore_fill(head, std::numeric_limits<size_t>::max(), pos_node, pos_index);
         }
-        return true;
     }
+};
 
-    bool operator!=(const unrolled_list &other) const { return !(*this == other); }
-    allocator_type get_allocator() const noexcept { return node_alloc; }
+// Segmented iterator traits in the style of Austern's "Segmented Iterators
+// and Hierarchical Algorithms": algorithms can split [first, last) into
+// whole segments and run a flat loop over local_iterator within each.
+template <typename Iterator, typename = void>
+struct segmented_iterator_traits
+{
+    static constexpr bool is_segmented = false;
+};
+
+template <typename Iterator>
+struct segmented_iterator_traits<Iterator, std::void_t<typename Iterator::segment_traits>> : Iterator::segment_traits
+{
 };
 
-template <typename T, std::size_t N, typename Alloc>
-void swap(unrolled_list<T, N, Alloc> &lhs, unrolled_list<T, N, Alloc> &rhs) noexcept
+namespace pmr
+{
+    template <typename T, std::size_t NodeMaxSize = 10, typename Policy = unrolled_list_policy>
+    using unrolled_list = ::unrolled_list<T, NodeMaxSize, std::pmr::polymorphic_allocator<T>, Policy>;
+}
+
+template <typename T, std::size_t N, typename Alloc, typename Policy>
+void swap(unrolled_list<T, N, Alloc, Policy> &lhs, unrolled_list<T, N, Alloc, Policy> &rhs) noexcept
 {
     lhs.swap(rhs);
 }
@@ -0,0 +1,422 @@
+#ifndef UNROLLED_QUEUE_H
+#define UNROLLED_QUEUE_H
+
+#include "epoch_reclaimer.h"
+#include "node_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+
+// FIFO queues over the unrolled_list block layout: blocks of NodeMaxSize
+// slots chained through next pointers. Producers fill the tail block in
+// place and consumers drain the head block in place, so no element ever
+// shifts. push_bulk and pop_bulk publish or claim a whole run of slots with
+// one atomic operation per block.
+
+// Defined by the unit tests to walk the block chain.
+struct unrolled_list_test_access;
+
+// Single producer, single consumer. The producer recycles every block the
+// consumer has left behind, so a steady-state queue allocates nothing.
+template <typename T, std::size_t NodeMaxSize = 64>
+class spsc_unrolled_queue
+{
+    static_assert(NodeMaxSize > 0, "blocks must hold at least one element");
+    friend struct unrolled_list_test_access;
+
+private:
+    struct Block
+    {
+        std::atomic<std::size_t> count{0};
+        std::atomic<Block *> next{nullptr};
+        alignas(alignof(T)) std::byte elements[NodeMaxSize * sizeof(T)];
+
+        T *slot(std::size_t index) noexcept { return std::launder(reinterpret_cast<T *>(&elements[index * sizeof(T)])); }
+    };
+
+    node_pool pool;
+
+    // Consumer side.
+    alignas(64) Block *head;
+    std::size_t head_pos = 0;
+    std::size_t head_count = 0;
+    std::atomic<Block *> consumer_block;
+
+    // Producer side.
+    alignas(64) Block *tail;
+    std::size_t tail_pos = 0;
+    Block *oldest;
+    Block *consumer_copy;
+
+    Block *new_block() { return ::new (pool.allocate(sizeof(Block), alignof(Block))) Block(); }
+
+    // Blocks before the consumer's current one are drained for good.
+    Block *acquire_block()
+    {
+        if (oldest == consumer_copy)
+            consumer_copy = consumer_block.load(std::memory_order_acquire);
+        if (oldest == consumer_copy)
+            return new_block();
+        Block *block = oldest;
+        oldest = block->next.load(std::memory_order_relaxed);
+        block->count.store(0, std::memory_order_relaxed);
+        block->next.store(nullptr, std::memory_order_relaxed);
+        return block;
+    }
+
+    void advance_tail()
+    {
+        Block *block = acquire_block();
+        tail->next.store(block, std::memory_order_release);
+        tail = block;
+        tail_pos = 0;
+    }
+
+    // Moves the consumer to a block with unread elements, if there is one.
+    bool readable()
+    {
+        if (head_pos < head_count)
+            return true;
+        head_count = head->count.load(std::memory_order_acquire);
+        if (head_pos < head_count)
+            return true;
+        if (head_pos < NodeMaxSize)
+            return false;
+        Block *next = head->next.load(std::memory_order_acquire);
+        if (!next)
+            return false;
+        head = next;
+        head_pos = 0;
+        consumer_block.store(head, std::memory_order_release);
+        head_count = head->count.load(std::memory_order_acquire);
+        return head_count > 0;
+    }
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    static constexpr size_type node_capacity = NodeMaxSize;
+
+    spsc_unrolled_queue() : pool(16), head(new_block()), consumer_block(head), tail(head), oldest(head), consumer_copy(head)
+    {
+    }
+
+    spsc_unrolled_queue(const spsc_unrolled_queue &) = delete;
+    spsc_unrolled_queue &operator=(const spsc_unrolled_queue &) = delete;
+
+    ~spsc_unrolled_queue()
+    {
+        while (readable())
+        {
+            head->slot(head_pos++)->~T();
+        }
+    }
+
+    template <typename... Args>
+    void emplace(Args &&...args)
+    {
+        if (tail_pos == NodeMaxSize)
+            advance_tail();
+        ::new (tail->slot(tail_pos)) T(std::forward<Args>(args)...);
+        tail->count.store(++tail_pos, std::memory_order_release);
+    }
+
+    void push(const T &value) { emplace(value); }
+    void push(T &&value) { emplace(std::move(value)); }
+
+    template <typename InputIt>
+    void push_bulk(InputIt first, InputIt last)
+    {
+        while (first != last)
+        {
+            if (tail_pos == NodeMaxSize)
+                advance_tail();
+            std::size_t pos = tail_pos;
+            for (; first != last && pos < NodeMaxSize; ++first, ++pos)
+            {
+                ::new (tail->slot(pos)) T(*first);
+            }
+            tail_pos = pos;
+            tail->count.store(pos, std::memory_order_release);
+        }
+    }
+
+    bool try_pop(T &out)
+    {
+        if (!readable())
+            return false;
+        T *item = head->slot(head_pos++);
+        out = std::move(*item);
+        item->~T();
+        return true;
+    }
+
+    // Pops up to max elements into out; returns how many.
+    template <typename OutputIt>
+    size_type pop_bulk(OutputIt out, size_type max)
+    {
+        size_type popped = 0;
+        while (popped < max && readable())
+        {
+            std::size_t end = std::min(head_count, head_pos + (max - popped));
+            for (; head_pos < end; ++head_pos, ++popped)
+            {
+                T *item = head->slot(head_pos);
+                *out = std::move(*item);
+                ++out;
+                item->~T();
+            }
+        }
+        return popped;
+    }
+
+    // Exact when called by the consumer.
+    bool empty() { return !readable(); }
+};
+
+// Multiple producers and consumers. A producer claims slots of the tail
+// block with a fetch_add on its reserved count and marks each slot ready
+// once written; a consumer claims slots with a CAS on the block's taken
+// count. Whoever finds the tail block full links the next one, and a block
+// the consumers have moved past is retired through an epoch_reclaimer back
+// into the block pool, so a thread still holding it never sees it reused.
+//
+// Claiming never blocks; a consumer whose slot is claimed but not yet
+// written waits for that one producer to finish the copy. A constructor
+// that throws would leave its slot unready, so pushes should not throw.
+template <typename T, std::size_t NodeMaxSize = 64>
+class mpmc_unrolled_queue
+{
+    static_assert(NodeMaxSize > 0, "blocks must hold at least one element");
+
+private:
+    struct Block
+    {
+        alignas(64) std::atomic<std::size_t> reserved{0};
+        alignas(64) std::atomic<std::size_t> taken{0};
+        std::atomic<Block *> next{nullptr};
+        std::atomic<bool> ready[NodeMaxSize]{};
+        alignas(alignof(T)) std::byte elements[NodeMaxSize * sizeof(T)];
+
+        T *slot(std::size_t index) noexcept { return std::launder(reinterpret_cast<T *>(&elements[index * sizeof(T)])); }
+    };
+
+    std::mutex pool_mutex;
+    node_pool pool;
+    alignas(64) std::atomic<Block *> head;
+    alignas(64) std::atomic<Block *> tail;
+    epoch_reclaimer reclaimer;
+
+    Block *new_block()
+    {
+        void *memory;
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            memory = pool.allocate(sizeof(Block), alignof(Block));
+        }
+        return ::new (memory) Block();
+    }
+
+    void free_block(Block *block) noexcept
+    {
+        block->~Block();
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        pool.deallocate(block, sizeof(Block), alignof(Block));
+    }
+
+    static void release_block(void *queue, void *block) noexcept
+    {
+        static_cast<mpmc_unrolled_queue *>(queue)->free_block(static_cast<Block *>(block));
+    }
+
+    // Links a successor to the full block and swings tail past it.
+    Block *advance_tail(Block *block)
+    {
+        Block *next = block->next.load(std::memory_order_acquire);
+        if (!next)
+        {
+            Block *fresh = new_block();
+            if (block->next.compare_exchange_strong(next, fresh, std::memory_order_acq_rel))
+                next = fresh;
+            else
+                free_block(fresh);
+        }
+        tail.compare_exchange_strong(block, next, std::memory_order_acq_rel);
+        return next;
+    }
+
+    static void wait_ready(Block *block, std::size_t index) noexcept
+    {
+        unsigned spins = 0;
+        while (!block->ready[index].load(std::memory_order_acquire))
+        {
+            if (++spins > 64)
+                std::this_thread::yield();
+        }
+    }
+
+    // Claims up to max slots of the head block as [first, first + count);
+    // false when the queue is empty.
+    bool claim(std::size_t max, Block *&block, std::size_t &first, std::size_t &count)
+    {
+        for (;;)
+        {
+            block = head.load(std::memory_order_acquire);
+            std::size_t taken = block->taken.load(std::memory_order_acquire);
+            if (taken < NodeMaxSize)
+            {
+                std::size_t available = std::min(block->reserved.load(std::memory_order_acquire), NodeMaxSize);
+                if (taken >= available)
+                    return false;
+                std::size_t n = std::min(max, available - taken);
+                if (block->taken.compare_exchange_weak(taken, taken + n, std::memory_order_acq_rel))
+                {
+                    first = taken;
+                    count = n;
+                    return true;
+                }
+                continue;
+            }
+            Block *next = block->next.load(std::memory_order_acquire);
+            if (!next)
+                return false;
+            Block *expected = block;
+            tail.compare_exchange_strong(expected, next, std::memory_order_acq_rel);
+            if (head.compare_exchange_strong(block, next, std::memory_order_acq_rel))
+                reclaimer.retire(block, &release_block, this);
+        }
+    }
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    static constexpr size_type node_capacity = NodeMaxSize;
+
+    mpmc_unrolled_queue() : pool(16), head(new_block()), tail(head.load()) {}
+
+    mpmc_unrolled_queue(const mpmc_unrolled_queue &) = delete;
+    mpmc_unrolled_queue &operator=(const mpmc_unrolled_queue &) = delete;
+
+    // No other thread may use the queue while it is destroyed.
+    ~mpmc_unrolled_queue()
+    {
+        Block *block;
+        std::size_t index;
+        std::size_t count;
+        while (claim(NodeMaxSize, block, index, count))
+        {
+            for (std::size_t end = index + count; index < end; ++index)
+            {
+                block->slot(index)->~T();
+            }
+        }
+    }
+
+    template <typename... Args>
+    void emplace(Args &&...args)
+    {
+        epoch_guard guard(reclaimer);
+        Block *block = tail.load(std::memory_order_acquire);
+        for (;;)
+        {
+            std::size_t index = block->reserved.fetch_add(1, std::memory_order_acq_rel);
+            if (index < NodeMaxSize)
+            {
+                ::new (block->slot(index)) T(std::forward<Args>(args)...);
+                block->ready[index].store(true, std::memory_order_release);
+                return;
+            }
+            block = advance_tail(block);
+        }
+    }
+
+    void push(const T &value) { emplace(value); }
+    void push(T &&value) { emplace(std::move(value)); }
+
+    template <typename ForwardIt>
+    void push_bulk(ForwardIt first, ForwardIt last)
+    {
+        epoch_guard guard(reclaimer);
+        std::size_t remaining = static_cast<std::size_t>(std::distance(first, last));
+        Block *block = tail.load(std::memory_order_acquire);
+        while (remaining)
+        {
+            std::size_t index = block->reserved.fetch_add(std::min(remaining, NodeMaxSize), std::memory_order_acq_rel);
+            if (index < NodeMaxSize)
+            {
+                std::size_t end = std::min(NodeMaxSize, index + std::min(remaining, NodeMaxSize));
+                for (; index < end; ++index, ++first, --remaining)
+                {
+                    ::new (block->slot(index)) T(*first);
+                    block->ready[index].store(true, std::memory_order_release);
+                }
+            }
+            if (remaining)
+                block = advance_tail(block);
+        }
+    }
+
+    bool try_pop(T &out)
+    {
+        epoch_guard guard(reclaimer);
+        Block *block;
+        std::size_t index;
+        std::size_t count;
+        if (!claim(1, block, index, count))
+            return false;
+        wait_ready(block, index);
+        T *item = block->slot(index);
+        out = std::move(*item);
+        item->~T();
+        return true;
+    }
+
+    // Pops up to max elements into out; returns how many. Stops early at a
+    // block boundary only when the queue is empty.
+    template <typename OutputIt>
+    size_type pop_bulk(OutputIt out, size_type max)
+    {
+        epoch_guard guard(reclaimer);
+        size_type popped = 0;
+        Block *block;
+        std::size_t index;
+        std::size_t count;
+        while (popped < max && claim(max - popped, block, index, count))
+        {
+            for (std::size_t end = index + count; index < end; ++index, ++popped)
+            {
+                wait_ready(block, index);
+                T *item = block->slot(index);
+                *out = std::move(*item);
+                ++out;
+                item->~T();
+            }
+        }
+        return popped;
+    }
+
+    // A snapshot that may be stale by the time it returns.
+    bool empty()
+    {
+        epoch_guard guard(reclaimer);
+        for (Block *block = head.load(std::memory_order_acquire); block;
+             block = block->next.load(std::memory_order_acquire))
+        {
+            std::size_t taken = block->taken.load(std::memory_order_acquire);
+            if (taken < std::min(block->reserved.load(std::memory_order_acquire), NodeMaxSize))
+                return false;
+            if (taken < NodeMaxSize)
+                return true;
+        }
+        return true;
+    }
+};
+
+#endif